@@ -53,6 +53,9 @@ typedef enum {
 int *const QV_THREAD_SCOPE_SPLIT_PACKED              = (int *)0x00000001;
 int *const QV_THREAD_SCOPE_SPLIT_SPREAD              = (int *)0x00000002;
 int *const QV_THREAD_SCOPE_SPLIT_AFFINITY_PRESERVING = (int *)0x00000003;
+int *const QV_THREAD_SCOPE_SPLIT_CPUKIND_PERF_FIRST   = (int *)0x00000004;
+int *const QV_THREAD_SCOPE_SPLIT_CPUKIND_BALANCED     = (int *)0x00000005;
+int *const QV_THREAD_SCOPE_SPLIT_AFFINITY_OPTIMAL     = (int *)0x00000006;
 
 int
 qv_thread_scope_split(
@@ -81,12 +84,66 @@ qv_thread_scopes_free(
     qv_scope_t **scopes
 );
 
+////////////////////////////////////////////////////////////////////////////////
+// Thread pools.
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A pool of persistent worker threads.
+ */
+typedef struct qv_thread_pool qv_thread_pool_t;
+
+/**
+ * Creates a pool of k workers, each bound to a piece of a thread split of the
+ * provided scope (see qv_thread_scope_split). Idle workers steal tasks from
+ * the workers that share the most hardware with them.
+ */
+int
+qv_thread_pool_create(
+    qv_scope_t *scope,
+    int npieces,
+    int *kcolors,
+    int k,
+    qv_thread_pool_t **pool
+);
+
+/**
+ * Submits a task to the pool. Tasks may submit tasks to the pool that runs
+ * them, which are then run by the submitting worker unless stolen.
+ */
+int
+qv_thread_pool_submit(
+    qv_thread_pool_t *pool,
+    void (*routine)(void *arg),
+    void *arg
+);
+
+/**
+ * Waits until all submitted tasks have completed.
+ * May not be called from a task.
+ */
+int
+qv_thread_pool_wait(
+    qv_thread_pool_t *pool
+);
+
+/**
+ * Waits for outstanding tasks, then stops and frees the pool.
+ * May not be called from a task.
+ */
+int
+qv_thread_pool_free(
+    qv_thread_pool_t *pool
+);
+
 ////////////////////////////////////////////////////////////////////////////////
 // Pthread-specific calls.
 ////////////////////////////////////////////////////////////////////////////////
 
 /**
- * Similar to pthread_create(3).
+ * Similar to pthread_create(3). The thread is bound to the provided scope,
+ * which must come from qv_thread_scope_split*. If attr is NULL, the thread
+ * starts on the scope's resources; otherwise it moves there once started.
  */
 int
 qv_pthread_create(
@@ -97,6 +154,22 @@ qv_pthread_create(
     qv_scope_t *scope
 );
 
+/**
+ * Creates k threads as qv_pthread_create does, the i-th bound to scopes[i]
+ * and called with args[i], or with scopes[i] if args is NULL. No thread runs
+ * thread_routine until all k have been created. On failure, none of them
+ * does: the threads created so far exit and are joined before this returns.
+ */
+int
+qv_pthread_create_team(
+    pthread_t *threads,
+    const pthread_attr_t *attr,
+    void *(*thread_routine)(void *arg),
+    void **args,
+    int k,
+    qv_scope_t **scopes
+);
+
 #ifdef __cplusplus
 }
 #endif
@@ -23,6 +23,9 @@
 #ifndef QUO_VADIS_H
 #define QUO_VADIS_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -113,6 +116,16 @@ const qv_scope_flags_t QV_SCOPE_FLAG_NONE   = (0LL);
  */
 const qv_scope_flags_t QV_SCOPE_FLAG_NO_SMT = (1LL<<0);
 
+/**
+ * On hybrid CPUs, only use the most performant kind of cores.
+ */
+const qv_scope_flags_t QV_SCOPE_FLAG_PERF_CORES = (1LL<<1);
+
+/**
+ * On hybrid CPUs, only use the most energy-efficient kind of cores.
+ */
+const qv_scope_flags_t QV_SCOPE_FLAG_EFFICIENCY_CORES = (1LL<<2);
+
 /**
  * Hardware object types.
  */
@@ -129,6 +142,14 @@ typedef enum {
     QV_HW_OBJ_NUMANODE,
     /** Device types */
     QV_HW_OBJ_GPU,
+    QV_HW_OBJ_NIC,
+    /** Die (e.g., a chiplet) inside a package. */
+    QV_HW_OBJ_DIE,
+    /**
+     * Group of objects (e.g., a CCX or sub-NUMA cluster). When groups
+     * are nested, the outermost groups are used.
+     */
+    QV_HW_OBJ_GROUP,
     /** Sentinel value. */
     QV_HW_OBJ_LAST
 } qv_hw_obj_type_t;
@@ -148,6 +169,21 @@ const qv_bind_string_flags_t QV_BIND_STRING_LOGICAL = (1<<0);
  */
 const qv_bind_string_flags_t QV_BIND_STRING_PHYSICAL = (1<<1);
 
+/**
+ * Scope memory allocation flags.
+ */
+typedef int qv_scope_malloc_flags_t;
+
+/**
+ * No special allocation behavior.
+ */
+const qv_scope_malloc_flags_t QV_SCOPE_MALLOC_NONE = 0;
+
+/**
+ * Back allocations with huge pages when possible.
+ */
+const qv_scope_malloc_flags_t QV_SCOPE_MALLOC_HUGE_PAGES = (1<<0);
+
 /**
  * Automatic grouping options for qv_scope_split(). The following values can be
  * used instead of group_id to influence how automatic task grouping is
@@ -173,6 +209,22 @@ const int QV_SCOPE_SPLIT_PACKED = -3;
  *
  */
 const int QV_SCOPE_SPLIT_SPREAD = -4;
+/**
+ * Packed split that hands out cores from the most performant kind first, so
+ * lower-numbered pieces land on faster cores of hybrid CPUs.
+ */
+const int QV_SCOPE_SPLIT_CPUKIND_PERF_FIRST = -5;
+/**
+ * Packed split that gives each piece an equal share of every core kind.
+ */
+const int QV_SCOPE_SPLIT_CPUKIND_BALANCED = -6;
+/**
+ * Like QV_SCOPE_SPLIT_AFFINITY_PRESERVING, but the assignment of tasks to
+ * pieces maximizes the total overlap between the tasks' current affinities
+ * and their pieces while keeping the pieces balanced. This minimizes task
+ * migrations at the cost of a more expensive split.
+ */
+const int QV_SCOPE_SPLIT_AFFINITY_OPTIMAL = -7;
 
 /**
  *
@@ -195,6 +247,46 @@ typedef enum {
     QV_DEVICE_ID_ORDINAL
 } qv_device_id_type_t;
 
+/**
+ * Hardware distance kinds. A value of zero denotes an unknown distance.
+ */
+typedef enum {
+    /**
+     * Memory access latency: lower values are closer. Values are either
+     * relative (e.g., ACPI SLIT) or in nanoseconds (e.g., ACPI HMAT).
+     */
+    QV_HW_DISTANCE_LATENCY = 0,
+    /**
+     * Memory access bandwidth: higher values are closer. Values are either
+     * relative or in MiB/s (e.g., ACPI HMAT).
+     */
+    QV_HW_DISTANCE_BANDWIDTH
+} qv_hw_distance_kind_t;
+
+/**
+ * NUMA node memory attributes. A value of zero denotes an unknown value.
+ */
+typedef enum {
+    /** Memory capacity in bytes: higher is better. */
+    QV_NUMA_ATTR_CAPACITY = 0,
+    /** Bandwidth from the node's local CPUs in MiB/s: higher is better. */
+    QV_NUMA_ATTR_BANDWIDTH,
+    /** Latency from the node's local CPUs in nanoseconds: lower is better. */
+    QV_NUMA_ATTR_LATENCY
+} qv_numa_attr_t;
+
+/**
+ * Memory binding policies used by qv_scope_membind_push().
+ */
+typedef enum {
+    /** Allocate memory only on the scope's NUMA nodes. */
+    QV_MEMBIND_BIND = 0,
+    /** Interleave pages across the scope's NUMA nodes. */
+    QV_MEMBIND_INTERLEAVE,
+    /** Allocate pages on the NUMA node local to the first-touching thread. */
+    QV_MEMBIND_FIRSTTOUCH
+} qv_membind_policy_t;
+
 /**
  * Version query function.
  *
@@ -240,7 +332,22 @@ qv_scope_create(
     qv_scope_t *scope,
     qv_hw_obj_type_t type,
     int nobjs,
-    qv_scope_create_hints_t hint,
+    qv_scope_create_hints_t hints,
+    qv_scope_t **subscope
+);
+
+/**
+ * Creates a subscope with a small set of cores whose private and shared data
+ * caches together hold a working set of nbytes. Cores are picked greedily by
+ * the cache capacity they add, so the set is not guaranteed to be minimal.
+ * Returns QV_RES_UNAVAILABLE if the scope's caches cannot hold the working
+ * set.
+ */
+int
+qv_scope_create_cache(
+    qv_scope_t *scope,
+    uint64_t nbytes,
+    qv_scope_create_hints_t hints,
     qv_scope_t **subscope
 );
 
@@ -284,6 +391,58 @@ qv_scope_device_id_get(
     char **dev_id
 );
 
+/**
+ * Returns the distance matrix of the NUMA nodes local to the provided scope,
+ * ordered by logical index. The matrix is stored in row-major order: entry
+ * (i, j) is the distance from the processors of node i to the memory of node
+ * j. The caller is responsible for freeing the returned matrix with free().
+ */
+int
+qv_scope_numa_distances(
+    qv_scope_t *scope,
+    qv_hw_distance_kind_t kind,
+    int *nnodes,
+    uint64_t **matrix
+);
+
+/**
+ * Returns the distance between two hardware objects of the provided type
+ * contained within the scope. The distance is that between the NUMA nodes
+ * local to each object.
+ */
+int
+qv_scope_hw_obj_distance(
+    qv_scope_t *scope,
+    qv_hw_obj_type_t obj,
+    int obj_index_a,
+    int obj_index_b,
+    qv_hw_distance_kind_t kind,
+    uint64_t *distance
+);
+
+/**
+ * Returns the value of the provided memory attribute for the NUMA node at the
+ * given index. Indices are relative to the NUMA nodes local to the scope.
+ */
+int
+qv_scope_numa_attr(
+    qv_scope_t *scope,
+    int numa_index,
+    qv_numa_attr_t attr,
+    uint64_t *value
+);
+
+/**
+ * Returns the index of the scope's NUMA node with the best value of the
+ * provided attribute, e.g., the highest-bandwidth or largest-capacity node.
+ */
+int
+qv_scope_numa_best(
+    qv_scope_t *scope,
+    qv_numa_attr_t attr,
+    int *numa_index
+);
+
 /**
  *
  */
@@ -293,7 +452,13 @@ qv_scope_barrier(
 );
 
 /**
- *
+ * Splits the scope into npieces pieces, giving the caller the piece of the
+ * provided group. Results are memoized per scope: when every member repeats a
+ * split with the same arguments and CPU binding, the split is not recomputed,
+ * and the new subscopes share their group with the earlier subscopes from the
+ * same split. Each scope keeps the groups of up to its 8 most recent distinct
+ * splits (and, with MPI, their communicators) until it is freed. This also
+ * applies to qv_scope_split_at() and qv_scope_split_weighted().
  */
 int
 qv_scope_split(
@@ -304,7 +469,26 @@ qv_scope_split(
 );
 
 /**
- *
+ * Splits the scope into one piece per member of its group. Each piece's share
+ * of the scope's PUs is proportional to the positive weight its member
+ * provides, so a member passing 3 receives three times the resources of one
+ * passing 1. Resources are handed out as whole cores when every member's share
+ * amounts to at least one core, and as PUs otherwise. Every member receives at
+ * least one PU, so shares only follow the weights as closely as the number of
+ * PUs allows. All of the scope's PUs are distributed.
+ */
+int
+qv_scope_split_weighted(
+    qv_scope_t *scope,
+    int weight,
+    qv_scope_t **subscope
+);
+
+/**
+ * Splits the scope into one piece per hardware object of the provided type.
+ * Splitting at QV_HW_OBJ_NUMANODE yields one piece per NUMA domain: NUMA nodes
+ * local to the same CPUs, like a package's DRAM and HBM, are memory tiers of
+ * one piece (see qv_scope_membind_push_tier()).
  */
 int
 qv_scope_split_at(
@@ -341,7 +525,68 @@ qv_scope_bind_string(
 );
 
 /**
- * Releases resources associated with the provided scope.
+ * Changes the calling thread's memory binding to the NUMA nodes local to the
+ * provided scope using the given policy. The previous binding is saved so it
+ * can be restored by qv_scope_membind_pop(). Returns QV_ERR_NOT_SUPPORTED,
+ * as does qv_scope_membind_pop(), where memory bindings cannot be queried.
+ */
+int
+qv_scope_membind_push(
+    qv_scope_t *scope,
+    qv_membind_policy_t policy
+);
+
+/**
+ * Like qv_scope_membind_push(), but only binds to the scope's memory tier that
+ * is best according to the provided attribute. A tier is the set of NUMA nodes
+ * sharing a memory subtype (e.g., HBM) with the best node.
+ */
+int
+qv_scope_membind_push_tier(
+    qv_scope_t *scope,
+    qv_membind_policy_t policy,
+    qv_numa_attr_t attr
+);
+
+/**
+ * Restores the calling thread's memory binding to
+ * the one in effect before the last qv_scope_membind_push().
+ */
+int
+qv_scope_membind_pop(
+    qv_scope_t *scope
+);
+
+/**
+ * Allocates size bytes of memory placed on the NUMA nodes local to the provided
+ * scope. The memory must be released with qv_scope_mfree() before the scope is
+ * freed. Memory may be freed by any thread.
+ */
+int
+qv_scope_malloc(
+    qv_scope_t *scope,
+    size_t size,
+    qv_scope_malloc_flags_t flags,
+    void **ptr
+);
+
+/**
+ * Frees memory allocated by qv_scope_malloc() on the provided scope.
+ */
+int
+qv_scope_mfree(
+    qv_scope_t *scope,
+    void *ptr
+);
+
+/**
+ * Releases resources associated with the provided scope. With MPI, the
+ * communicators of split scopes are kept for reuse by identical splits after
+ * their scopes are freed. They are freed when the last scope using the group
+ * they were split from is freed, unless a member still uses them. That free
+ * is collective over the group, so its members must free such scopes in the
+ * same order. Remaining communicators are freed with the last scope derived
+ * from the same qv_mpi_scope_get() call.
  */
 int
 qv_scope_free(
@@ -49,6 +49,12 @@ module quo_vadisf
     integer(c_long_long), parameter :: QV_SCOPE_FLAG_NO_SMT = &
         int(ishft(1, 0), kind=c_long_long)
 
+    integer(c_long_long), parameter :: QV_SCOPE_FLAG_PERF_CORES = &
+        int(ishft(1, 1), kind=c_long_long)
+
+    integer(c_long_long), parameter :: QV_SCOPE_FLAG_EFFICIENCY_CORES = &
+        int(ishft(1, 2), kind=c_long_long)
+
     !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
     ! Hardware Object Types
     !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
@@ -63,7 +69,10 @@ module quo_vadisf
     integer(c_int), parameter :: QV_HW_OBJ_L5CACHE = 8
     integer(c_int), parameter :: QV_HW_OBJ_NUMANODE = 9
     integer(c_int), parameter :: QV_HW_OBJ_GPU = 10
-    integer(c_int), parameter :: QV_HW_OBJ_LAST = 11
+    integer(c_int), parameter :: QV_HW_OBJ_NIC = 11
+    integer(c_int), parameter :: QV_HW_OBJ_DIE = 12
+    integer(c_int), parameter :: QV_HW_OBJ_GROUP = 13
+    integer(c_int), parameter :: QV_HW_OBJ_LAST = 14
 
     !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
     ! Binding string representation format flags.
@@ -79,6 +88,11 @@ module quo_vadisf
     !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
     integer(c_int), parameter :: QV_SCOPE_SPLIT_UNDEFINED = -1
     integer(c_int), parameter :: QV_SCOPE_SPLIT_AFFINITY_PRESERVING = -2
+    integer(c_int), parameter :: QV_SCOPE_SPLIT_PACKED = -3
+    integer(c_int), parameter :: QV_SCOPE_SPLIT_SPREAD = -4
+    integer(c_int), parameter :: QV_SCOPE_SPLIT_CPUKIND_PERF_FIRST = -5
+    integer(c_int), parameter :: QV_SCOPE_SPLIT_CPUKIND_BALANCED = -6
+    integer(c_int), parameter :: QV_SCOPE_SPLIT_AFFINITY_OPTIMAL = -7
 
     !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
     ! Device ID types
@@ -87,6 +101,26 @@ module quo_vadisf
     integer(c_int), parameter :: QV_DEVICE_ID_PCI_BUS_ID = 1
     integer(c_int), parameter :: QV_DEVICE_ID_ORDINAL = 2
 
+    !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+    ! Hardware distance kinds
+    !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+    integer(c_int), parameter :: QV_HW_DISTANCE_LATENCY = 0
+    integer(c_int), parameter :: QV_HW_DISTANCE_BANDWIDTH = 1
+
+    !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+    ! NUMA node memory attributes
+    !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+    integer(c_int), parameter :: QV_NUMA_ATTR_CAPACITY = 0
+    integer(c_int), parameter :: QV_NUMA_ATTR_BANDWIDTH = 1
+    integer(c_int), parameter :: QV_NUMA_ATTR_LATENCY = 2
+
+    !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+    ! Memory binding policies
+    !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+    integer(c_int), parameter :: QV_MEMBIND_BIND = 0
+    integer(c_int), parameter :: QV_MEMBIND_INTERLEAVE = 1
+    integer(c_int), parameter :: QV_MEMBIND_FIRSTTOUCH = 2
+
 interface
     pure function qvif_strlen_c(s) &
         bind(c, name="strlen")
@@ -137,6 +171,18 @@ interface
         type(c_ptr), intent(out) :: subscope
     end function qv_scope_split_c
 
+    integer(c_int) &
+    function qv_scope_split_weighted_c( &
+        scope, weight, subscope &
+    ) &
+        bind(c, name='qv_scope_split_weighted')
+        use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+        implicit none
+        type(c_ptr), value :: scope
+        integer(c_int), value :: weight
+        type(c_ptr), intent(out) :: subscope
+    end function qv_scope_split_weighted_c
+
     integer(c_int) &
     function qv_scope_split_at_c( &
         scope, obj_type, group_id, subscope &
@@ -226,6 +272,23 @@ interface
         type(c_ptr), intent(out) :: str
     end function qv_scope_bind_string_c
 
+    integer(c_int) &
+    function qv_scope_membind_push_c(scope, policy) &
+        bind(c, name='qv_scope_membind_push')
+        use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+        implicit none
+        type(c_ptr), value :: scope
+        integer(c_int), value :: policy
+    end function qv_scope_membind_push_c
+
+    integer(c_int) &
+    function qv_scope_membind_pop_c(scope) &
+        bind(c, name='qv_scope_membind_pop')
+        use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+        implicit none
+        type(c_ptr), value :: scope
+    end function qv_scope_membind_pop_c
+
     type(c_ptr) &
     function qv_strerr_c(ec) &
         bind(c, name='qv_strerr')
@@ -299,6 +362,20 @@ contains
         )
     end subroutine qv_scope_split
 
+    subroutine qv_scope_split_weighted( &
+        scope, weight, subscope, info &
+    )
+        use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+        implicit none
+        type(c_ptr), value :: scope
+        integer(c_int), value :: weight
+        type(c_ptr), intent(out) :: subscope
+        integer(c_int), intent(out) :: info
+        info = qv_scope_split_weighted_c( &
+            scope, weight, subscope &
+        )
+    end subroutine qv_scope_split_weighted
+
     subroutine qv_scope_split_at( &
         scope, obj_type, group_id, subscope, info &
     )
@@ -414,6 +491,23 @@ contains
         call qvif_free_c(cstr)
     end subroutine
 
+    subroutine qv_scope_membind_push(scope, policy, info)
+        use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+        implicit none
+        type(c_ptr), value :: scope
+        integer(c_int), value :: policy
+        integer(c_int), intent(out) :: info
+        info = qv_scope_membind_push_c(scope, policy)
+    end subroutine qv_scope_membind_push
+
+    subroutine qv_scope_membind_pop(scope, info)
+        use, intrinsic :: iso_c_binding, only: c_ptr, c_int
+        implicit none
+        type(c_ptr), value :: scope
+        integer(c_int), intent(out) :: info
+        info = qv_scope_membind_pop_c(scope)
+    end subroutine qv_scope_membind_pop
+
 end module quo_vadisf
 
 ! vim: ft=fortran ts=4 sts=4 sw=4 expandtab
@@ -21,22 +21,64 @@
 #include "quo-vadis-thread.h"
 #include "qvi-group-pthread.h"
 #include "qvi-scope.h"
+#include "qvi-thread-pool.h"
 #include "qvi-utils.h"
 
+/**
+ * Holds back the threads of a team until all of them have been created, so
+ * that none runs its routine unless the whole team does.
+ */
+struct qvi_pthread_gate {
+    std::mutex mutex;
+    std::condition_variable cv;
+    /** Whether the team's fate is decided. */
+    bool open = false;
+    /** Whether the team's threads may run their routines. */
+    bool run = false;
+    /** Lets the waiting threads through, telling them whether to run. */
+    void
+    release(
+        bool run_a
+    ) {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            open = true;
+            run = run_a;
+        }
+        cv.notify_all();
+    }
+    /** Waits for release, returning whether the caller may run. */
+    bool
+    pass(void)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&] { return open; });
+        return run;
+    }
+};
+
 struct qvi_pthread_args {
     qv_scope_t *scope = nullptr;
     qvi_pthread_routine_fun_ptr_t th_routine = nullptr;
     void *th_routine_argp = nullptr;
+    /** Whether the thread starts bound to the scope's cpuset. */
+    bool prebound = false;
+    /** The team's gate, if the thread is part of a team. */
+    std::shared_ptr<qvi_pthread_gate> gate;
     /** Default constructor. */
     qvi_pthread_args(void) = delete;
     /** Constructor. */
     qvi_pthread_args(
         qv_scope_t *scope_a,
         qvi_pthread_routine_fun_ptr_t th_routine_a,
-        void *th_routine_argp_a
+        void *th_routine_argp_a,
+        bool prebound_a,
+        const std::shared_ptr<qvi_pthread_gate> &gate_a
     ) : scope(scope_a)
       , th_routine(th_routine_a)
-      , th_routine_argp(th_routine_argp_a) { }
+      , th_routine_argp(th_routine_argp_a)
+      , prebound(prebound_a)
+      , gate(gate_a) { }
 };
 
 static void *
@@ -44,8 +86,14 @@ qvi_pthread_start_routine(
     void *arg
 ) {
     qvi_pthread_args *args = (qvi_pthread_args *)arg;
-
-    const int rc = args->scope->bind_push();
+    // Team members whose team failed to start leave without running.
+    if (args->gate && !args->gate->pass()) {
+        qvi_delete(&args);
+        pthread_exit(nullptr);
+    }
+    // Threads that started on the scope's cpuset need not be moved there.
+    const int rc = args->prebound ?
+        args->scope->bind_push_assumed() : args->scope->bind_push();
     if (qvi_unlikely(rc != QV_SUCCESS)) {
         qvi_log_error(
             "An error occurred in bind_push(): {} ({})", rc, qv_strerr(rc)
@@ -79,6 +127,15 @@ split_color_fixup(
     else if (kcolors == QV_THREAD_SCOPE_SPLIT_AFFINITY_PRESERVING) {
         real_color = QV_SCOPE_SPLIT_AFFINITY_PRESERVING;
     }
+    else if (kcolors == QV_THREAD_SCOPE_SPLIT_CPUKIND_PERF_FIRST) {
+        real_color = QV_SCOPE_SPLIT_CPUKIND_PERF_FIRST;
+    }
+    else if (kcolors == QV_THREAD_SCOPE_SPLIT_CPUKIND_BALANCED) {
+        real_color = QV_SCOPE_SPLIT_CPUKIND_BALANCED;
+    }
+    else if (kcolors == QV_THREAD_SCOPE_SPLIT_AFFINITY_OPTIMAL) {
+        real_color = QV_SCOPE_SPLIT_AFFINITY_OPTIMAL;
+    }
     // Nothing to do. An automatic coloring was not requested.
     if (real_color == QV_SCOPE_SPLIT_UNDEFINED) {
         return QV_SUCCESS;
@@ -152,36 +209,189 @@ qv_thread_scopes_free(
 }
 
 int
-qv_pthread_create(
+qv_thread_pool_create(
+    qv_scope_t *scope,
+    int npieces,
+    int *kcolors,
+    int k,
+    qv_thread_pool_t **pool
+) {
+    const bool invalid_args = !scope || npieces < 0 || k < 1 || !pool;
+    if (qvi_unlikely(invalid_args)) {
+        return QV_ERR_INVLD_ARG;
+    }
+    try {
+        std::vector<int> color_fixup;
+        const int rc = split_color_fixup(kcolors, k, color_fixup);
+        if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+        // Set the colors array to the appropriate data.
+        int *kcolorsp = color_fixup.empty() ? kcolors : color_fixup.data();
+        return qvi_new(pool, scope, npieces, kcolorsp, k);
+    }
+    qvi_catch_and_return();
+}
+
+int
+qv_thread_pool_submit(
+    qv_thread_pool_t *pool,
+    void (*routine)(void *arg),
+    void *arg
+) {
+    if (qvi_unlikely(!pool || !routine)) {
+        return QV_ERR_INVLD_ARG;
+    }
+    try {
+        return pool->submit(routine, arg);
+    }
+    qvi_catch_and_return();
+}
+
+int
+qv_thread_pool_wait(
+    qv_thread_pool_t *pool
+) {
+    if (qvi_unlikely(!pool)) {
+        return QV_ERR_INVLD_ARG;
+    }
+    try {
+        return pool->wait();
+    }
+    qvi_catch_and_return();
+}
+
+int
+qv_thread_pool_free(
+    qv_thread_pool_t *pool
+) {
+    if (qvi_unlikely(!pool)) {
+        return QV_ERR_INVLD_ARG;
+    }
+    try {
+        // Tasks may not free the pool that runs them.
+        const int rc = pool->wait();
+        if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+        qvi_delete(&pool);
+        return QV_SUCCESS;
+    }
+    qvi_catch_and_return();
+}
+
+/**
+ * Implements qv_pthread_create. Threads given a gate wait on it before
+ * running thread_routine.
+ */
+static int
+qvi_pthread_create(
     pthread_t *thread,
     const pthread_attr_t *attr,
     qvi_pthread_routine_fun_ptr_t thread_routine,
     void *arg,
-    qv_scope_t *scope
+    qv_scope_t *scope,
+    const std::shared_ptr<qvi_pthread_gate> &gate
 ) {
+    // Note: The provided scope should have been created by
+    // qv_thread_scope_split*, so its underlying group is a thread group.
+    auto group = dynamic_cast<qvi_group_thread *>(&scope->group());
+    if (qvi_unlikely(!group)) return EINVAL;
+    // Unless the caller provided attributes, which we may not change, start
+    // the thread on the scope's cpuset rather than moving it there once it
+    // has started. If that fails, fall back to moving it.
+    pthread_attr_t pbattr;
+    bool prebound = false;
+    if (!attr && pthread_attr_init(&pbattr) == 0) {
+        const int rc = scope->group().hwloc().pthread_attr_set_cpubind(
+            &pbattr, scope->hwpool().cpuset().cdata()
+        );
+        if (qvi_likely(rc == QV_SUCCESS)) {
+            attr = &pbattr;
+            prebound = true;
+        }
+        else {
+            pthread_attr_destroy(&pbattr);
+        }
+    }
     // Memory will be freed in qv_pthread_routine to avoid memory leaks.
     qvi_pthread_args *pthread_start_args = nullptr;
-    int rc = qvi_new(&pthread_start_args, scope, thread_routine, arg);
+    int rc = qvi_new(
+        &pthread_start_args, scope, thread_routine, arg, prebound, gate
+    );
+    qvi_pthread_create_args *cargs = nullptr;
+    if (qvi_likely(rc == QV_SUCCESS)) {
+        rc = qvi_new(
+            &cargs, group, qvi_pthread_start_routine, pthread_start_args
+        );
+    }
     // Since this is meant to behave similarly to
     // pthread_create(), return a reasonable errno.
-    if (qvi_unlikely(rc != QV_SUCCESS)) return ENOMEM;
-    // Note: The provided scope should have been created by
-    // qv_pthread_scope_split*. That is why we can safely cast the scope's
-    // underlying group it to a qvi_group_pthread *.
-    auto group = dynamic_cast<qvi_group_pthread *>(&scope->group());
-    qvi_pthread_create_args *cargs = nullptr;
-    rc = qvi_new(
-        &cargs, group, qvi_pthread_start_routine, pthread_start_args
-    );
-    if (qvi_unlikely(rc != QV_SUCCESS)) {
+    int erc = ENOMEM;
+    if (qvi_likely(rc == QV_SUCCESS)) {
+        erc = pthread_create(
+            thread, attr,
+            qvi_group_pthread::call_first_from_pthread_create, cargs
+        );
+    }
+    if (qvi_unlikely(erc != 0)) {
+        qvi_delete(&cargs);
         qvi_delete(&pthread_start_args);
-        return ENOMEM;
     }
-    return pthread_create(
-        thread, attr, qvi_group_pthread::call_first_from_pthread_create, cargs
+    if (prebound) pthread_attr_destroy(&pbattr);
+    return erc;
+}
+
+int
+qv_pthread_create(
+    pthread_t *thread,
+    const pthread_attr_t *attr,
+    qvi_pthread_routine_fun_ptr_t thread_routine,
+    void *arg,
+    qv_scope_t *scope
+) {
+    if (qvi_unlikely(!thread || !thread_routine || !scope)) return EINVAL;
+    return qvi_pthread_create(
+        thread, attr, thread_routine, arg, scope, nullptr
     );
 }
 
+int
+qv_pthread_create_team(
+    pthread_t *threads,
+    const pthread_attr_t *attr,
+    qvi_pthread_routine_fun_ptr_t thread_routine,
+    void **args,
+    int k,
+    qv_scope_t **scopes
+) {
+    if (qvi_unlikely(!threads || !thread_routine || k < 0 || !scopes)) {
+        return EINVAL;
+    }
+    for (int i = 0; i < k; ++i) {
+        if (qvi_unlikely(!scopes[i])) return EINVAL;
+    }
+    std::shared_ptr<qvi_pthread_gate> gate;
+    try {
+        gate = std::make_shared<qvi_pthread_gate>();
+    }
+    catch (const std::bad_alloc &) {
+        return ENOMEM;
+    }
+    for (int i = 0; i < k; ++i) {
+        void *const arg = args ? args[i] : scopes[i];
+        const int rc = qvi_pthread_create(
+            &threads[i], attr, thread_routine, arg, scopes[i], gate
+        );
+        if (qvi_unlikely(rc != 0)) {
+            // Send the threads created so far away and reap them.
+            gate->release(false);
+            for (int j = 0; j < i; ++j) {
+                pthread_join(threads[j], nullptr);
+            }
+            return rc;
+        }
+    }
+    gate->release(true);
+    return 0;
+}
+
 /*
  * vim: ft=cpp ts=4 sts=4 sw=4 expandtab
  */
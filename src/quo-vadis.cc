@@ -106,6 +106,80 @@ qv_scope_bind_string(
     qvi_catch_and_return();
 }
 
+int
+qv_scope_membind_push(
+    qv_scope_t *scope,
+    qv_membind_policy_t policy
+) {
+    if (qvi_unlikely(!scope)) {
+        return QV_ERR_INVLD_ARG;
+    }
+    try {
+        return scope->membind_push(policy);
+    }
+    qvi_catch_and_return();
+}
+
+int
+qv_scope_membind_push_tier(
+    qv_scope_t *scope,
+    qv_membind_policy_t policy,
+    qv_numa_attr_t attr
+) {
+    if (qvi_unlikely(!scope)) {
+        return QV_ERR_INVLD_ARG;
+    }
+    try {
+        return scope->membind_push_tier(policy, attr);
+    }
+    qvi_catch_and_return();
+}
+
+int
+qv_scope_membind_pop(
+    qv_scope_t *scope
+) {
+    if (qvi_unlikely(!scope)) {
+        return QV_ERR_INVLD_ARG;
+    }
+    try {
+        return scope->membind_pop();
+    }
+    qvi_catch_and_return();
+}
+
+int
+qv_scope_malloc(
+    qv_scope_t *scope,
+    size_t size,
+    qv_scope_malloc_flags_t flags,
+    void **ptr
+) {
+    if (qvi_unlikely(!scope || !ptr)) {
+        return QV_ERR_INVLD_ARG;
+    }
+    try {
+        return scope->mem_alloc(size, flags, ptr);
+    }
+    qvi_catch_and_return();
+}
+
+int
+qv_scope_mfree(
+    qv_scope_t *scope,
+    void *ptr
+) {
+    if (qvi_unlikely(!scope)) {
+        return QV_ERR_INVLD_ARG;
+    }
+    // Like free(), freeing a null pointer is a no-op.
+    if (!ptr) return QV_SUCCESS;
+    try {
+        return scope->mem_free(ptr);
+    }
+    qvi_catch_and_return();
+}
+
 int
 qv_scope_free(
     qv_scope_t *scope
@@ -197,6 +271,22 @@ qv_scope_create(
     qvi_catch_and_return();
 }
 
+int
+qv_scope_create_cache(
+    qv_scope_t *scope,
+    uint64_t nbytes,
+    qv_scope_create_hints_t hints,
+    qv_scope_t **subscope
+) {
+    if (qvi_unlikely(!scope || !subscope)) {
+        return QV_ERR_INVLD_ARG;
+    }
+    try {
+        return scope->create_cache(nbytes, hints, subscope);
+    }
+    qvi_catch_and_return();
+}
+
 int
 qv_scope_split(
     qv_scope_t *scope,
@@ -216,6 +306,21 @@ qv_scope_split(
     qvi_catch_and_return();
 }
 
+int
+qv_scope_split_weighted(
+    qv_scope_t *scope,
+    int weight,
+    qv_scope_t **subscope
+) {
+    if (qvi_unlikely(!scope || (weight <= 0) || !subscope)) {
+        return QV_ERR_INVLD_ARG;
+    }
+    try {
+        return scope->split_weighted(weight, subscope);
+    }
+    qvi_catch_and_return();
+}
+
 int
 qv_scope_split_at(
     qv_scope_t *scope,
@@ -249,6 +354,74 @@ qv_scope_device_id_get(
     qvi_catch_and_return();
 }
 
+int
+qv_scope_numa_distances(
+    qv_scope_t *scope,
+    qv_hw_distance_kind_t kind,
+    int *nnodes,
+    uint64_t **matrix
+) {
+    if (qvi_unlikely(!scope || !nnodes || !matrix)) {
+        return QV_ERR_INVLD_ARG;
+    }
+    try {
+        return scope->numa_distances(kind, nnodes, matrix);
+    }
+    qvi_catch_and_return();
+}
+
+int
+qv_scope_hw_obj_distance(
+    qv_scope_t *scope,
+    qv_hw_obj_type_t obj,
+    int obj_index_a,
+    int obj_index_b,
+    qv_hw_distance_kind_t kind,
+    uint64_t *distance
+) {
+    if (qvi_unlikely(!scope || (obj_index_a < 0) ||
+                     (obj_index_b < 0) || !distance)) {
+        return QV_ERR_INVLD_ARG;
+    }
+    try {
+        return scope->hw_obj_distance(
+            obj, obj_index_a, obj_index_b, kind, distance
+        );
+    }
+    qvi_catch_and_return();
+}
+
+int
+qv_scope_numa_attr(
+    qv_scope_t *scope,
+    int numa_index,
+    qv_numa_attr_t attr,
+    uint64_t *value
+) {
+    if (qvi_unlikely(!scope || (numa_index < 0) || !value)) {
+        return QV_ERR_INVLD_ARG;
+    }
+    try {
+        return scope->numa_attr(numa_index, attr, value);
+    }
+    qvi_catch_and_return();
+}
+
+int
+qv_scope_numa_best(
+    qv_scope_t *scope,
+    qv_numa_attr_t attr,
+    int *numa_index
+) {
+    if (qvi_unlikely(!scope || !numa_index)) {
+        return QV_ERR_INVLD_ARG;
+    }
+    try {
+        return scope->numa_best(attr, numa_index);
+    }
+    qvi_catch_and_return();
+}
+
 /*
  * vim: ft=cpp ts=4 sts=4 sw=4 expandtab
  */
@@ -97,7 +97,9 @@ struct qvid {
 
         qvi_log_info("--URL: {}", rmic.url);
         qvi_log_info("--Port Number: {}", rmic.portno);
-        qvi_log_info("--hwloc XML: {}", rmic.hwtopo_path);
+        if (!rmic.hwtopo_synthetic.empty()) {
+            qvi_log_info("--Synthetic Topology: {}", rmic.hwtopo_synthetic);
+        }
     }
 
     void
@@ -167,6 +169,7 @@ struct qvid {
             const cstr_t ers = "rmi.topology_export() failed";
             qvi_panic_log_error("{} (rc={}, {})", ers, rc, qv_strerr(rc));
         }
+        qvi_log_info("--hwloc XML: {}", rmic.hwtopo_path);
     }
 
     void
@@ -209,7 +212,8 @@ parse_args(
         FLOOR = 256,
         HELP,
         NO_DAEMONIZE,
-        PORT
+        PORT,
+        TOPOLOGY
     };
 
     const cstr_t opts = "";
@@ -217,12 +221,14 @@ parse_args(
         {"help"            , no_argument,       nullptr, HELP                 },
         {"no-daemonize"    , no_argument,       nullptr, NO_DAEMONIZE         },
         {"port"            , required_argument, nullptr, PORT                 },
+        {"topology"        , required_argument, nullptr, TOPOLOGY             },
         {nullptr           , 0,                 nullptr, 0                    }
     };
     static const option_help opt_help = {
         {"[--help]             ", "Show this message and exit."               },
         {"[--no-daemonize]     ", "Do not run as a daemon."                   },
-        {"[--port PORTNO]      ", "Specify port number to use."               }
+        {"[--port PORTNO]      ", "Specify port number to use."               },
+        {"[--topology DESC]    ", "Use an hwloc synthetic topology."          }
     };
 
     int opt;
@@ -238,6 +244,9 @@ parse_args(
                 qvd.rmic.portno = qvi_stoi(std::string(optarg));
                 break;
             }
+            case TOPOLOGY:
+                qvd.rmic.hwtopo_synthetic = std::string(optarg);
+                break;
             default:
                 show_usage(opt_help);
                 return QV_ERR_INVLD_ARG;
@@ -285,9 +294,10 @@ start(
         qvd.determine_connection_info();
         // Create our session directory.
         qvd.make_session_dir();
-        qvd.export_hwtopo();
-        // Configure RMI, start listening for commands.
+        // Configure RMI, which loads the hardware topology we publish.
         qvd.configure_rmi();
+        qvd.export_hwtopo();
+        // Start listening for commands.
         // This blocks until it is instructed to shutdown.
         qvd.start_rmi_server();
         // Cleanup
@@ -0,0 +1,356 @@
+/* -*- Mode: C++; c-basic-offset:4; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2025      Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the quo-vadis project. See the LICENSE file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * @file qvi-arena.cc
+ */
+
+#include "qvi-arena.h"
+#include "qvi-utils.h"
+
+/**
+ * Precedes every block handed out by an arena. The tag is the block's size
+ * class for chunk-carved blocks and the mapping length for large blocks.
+ */
+struct qvi_arena_block {
+    qvi_arena *arena;
+    uint64_t tag;
+};
+
+static_assert(
+    sizeof(qvi_arena_block) == 16,
+    "Arena blocks must preserve 16-byte alignment."
+);
+
+/**
+ * Free blocks are linked through the first word following their header,
+ * which leaves the header intact while a block sits on a free list.
+ */
+static void *&
+block_next(
+    void *block
+) {
+    byte_t *user = static_cast<byte_t *>(block) + sizeof(qvi_arena_block);
+    return *reinterpret_cast<void **>(user);
+}
+
+/** Live arenas by ID, so that exiting threads can return their blocks. */
+struct qvi_arena_registry {
+    std::mutex mutex;
+    std::unordered_map<uint64_t, qvi_arena *> arenas;
+};
+
+static qvi_arena_registry &
+arena_registry(void)
+{
+    // Never destroyed, since threads may exit after static destruction.
+    static qvi_arena_registry *registry = new qvi_arena_registry();
+    return *registry;
+}
+
+static size_t
+round_up(
+    size_t n,
+    size_t multiple
+) {
+    return ((n + multiple - 1) / multiple) * multiple;
+}
+
+qvi_arena::qvi_arena(
+    qvi_hwloc &hwloc,
+    const qvi_hwloc_bitmap &nodeset,
+    bool huge_pages
+) : m_hwloc(hwloc)
+  , m_nodeset(nodeset)
+  , m_huge_pages(huge_pages)
+{
+    static std::atomic<uint64_t> next_id(1);
+    m_id = next_id.fetch_add(1);
+
+    qvi_arena_registry &registry = arena_registry();
+    std::lock_guard<std::mutex> guard(registry.mutex);
+    registry.arenas.insert({m_id, this});
+}
+
+qvi_arena::~qvi_arena(void)
+{
+    {
+        qvi_arena_registry &registry = arena_registry();
+        std::lock_guard<std::mutex> guard(registry.mutex);
+        registry.arenas.erase(m_id);
+    }
+    for (const auto &chunk : m_chunks) {
+        munmap(chunk.first, chunk.second);
+    }
+    for (const auto &large : m_large) {
+        munmap(large.first, large.second);
+    }
+}
+
+size_t
+qvi_arena::s_class_size(
+    uint_t cls
+) {
+    return s_min_class_size << cls;
+}
+
+size_t
+qvi_arena::s_tcache_limit(
+    uint_t cls
+) {
+    return std::max<size_t>(4, s_tcache_bytes / s_class_size(cls));
+}
+
+qvi_arena::tcache &
+qvi_arena::m_tcache(void)
+{
+    // Keyed by arena ID rather than address so that a new arena never sees
+    // entries left behind by a destroyed one. Map references remain valid
+    // across rehashing, so the last lookup can be cached.
+    static thread_local tcache_set tcaches;
+    static thread_local uint64_t last_id = 0;
+    static thread_local tcache *last = nullptr;
+
+    if (qvi_unlikely(last_id != m_id)) {
+        last = &tcaches.tcaches[m_id];
+        last_id = m_id;
+    }
+    return *last;
+}
+
+qvi_arena::tcache_set::~tcache_set(void)
+{
+    // Holding the registry lock keeps the arenas from being destroyed.
+    qvi_arena_registry &registry = arena_registry();
+    std::lock_guard<std::mutex> guard(registry.mutex);
+    for (auto &entry : tcaches) {
+        const auto arena = registry.arenas.find(entry.first);
+        if (arena == registry.arenas.end()) continue;
+        arena->second->m_flush_all(entry.second);
+    }
+}
+
+qvi_arena *
+qvi_arena::owner(
+    void *ptr
+) {
+    return (static_cast<qvi_arena_block *>(ptr) - 1)->arena;
+}
+
+int
+qvi_arena::m_map(
+    size_t &length,
+    void **addr
+) {
+    static const size_t page_size = sysconf(_SC_PAGESIZE);
+
+    const int prot = PROT_READ | PROT_WRITE;
+    const int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+    void *iaddr = MAP_FAILED;
+    if (m_huge_pages) {
+        length = round_up(length, s_huge_page_size);
+#ifdef MAP_HUGETLB
+        iaddr = mmap(nullptr, length, prot, flags | MAP_HUGETLB, -1, 0);
+#endif
+        // No huge pages are reserved, so ask for transparent ones instead.
+        if (iaddr == MAP_FAILED) {
+            iaddr = mmap(nullptr, length, prot, flags, -1, 0);
+#ifdef MADV_HUGEPAGE
+            if (iaddr != MAP_FAILED) madvise(iaddr, length, MADV_HUGEPAGE);
+#endif
+        }
+    }
+    else {
+        length = round_up(length, page_size);
+        iaddr = mmap(nullptr, length, prot, flags, -1, 0);
+    }
+    if (qvi_unlikely(iaddr == MAP_FAILED)) return QV_ERR_OOR;
+    // Bind before first touch so pages are placed on our nodes.
+    const int rc = hwloc_set_area_membind(
+        m_hwloc.topology_get(), iaddr, length, m_nodeset.cdata(),
+        HWLOC_MEMBIND_BIND, HWLOC_MEMBIND_BYNODESET
+    );
+    if (qvi_unlikely(rc != 0)) {
+        munmap(iaddr, length);
+        return QV_ERR_NOT_SUPPORTED;
+    }
+    *addr = iaddr;
+    return QV_SUCCESS;
+}
+
+int
+qvi_arena::m_refill(
+    uint_t cls,
+    void **block
+) {
+    tcache_bin &bin = m_tcache()[cls];
+    const size_t csize = s_class_size(cls);
+    const size_t batch = s_tcache_limit(cls) / 2;
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+    // First take what other threads have returned to the arena.
+    while (m_free[cls] && bin.count < batch) {
+        void *iblock = m_free[cls];
+        m_free[cls] = block_next(iblock);
+        block_next(iblock) = bin.head;
+        bin.head = iblock;
+        bin.count++;
+    }
+    // Then carve new blocks from the current chunk.
+    while (bin.count < batch) {
+        if (m_cursor + csize > m_end) {
+            // Make do with what we have if we cannot map more.
+            size_t length = s_chunk_size;
+            void *chunk = nullptr;
+            const int rc = m_map(length, &chunk);
+            if (qvi_unlikely(rc != QV_SUCCESS)) {
+                if (bin.count > 0) break;
+                return rc;
+            }
+            m_chunks.emplace_back(chunk, length);
+            m_cursor = static_cast<byte_t *>(chunk);
+            m_end = m_cursor + length;
+        }
+        qvi_arena_block *hdr = reinterpret_cast<qvi_arena_block *>(m_cursor);
+        hdr->arena = this;
+        hdr->tag = cls;
+        m_cursor += csize;
+
+        block_next(hdr) = bin.head;
+        bin.head = hdr;
+        bin.count++;
+    }
+    *block = bin.head;
+    bin.head = block_next(*block);
+    bin.count--;
+    return QV_SUCCESS;
+}
+
+void
+qvi_arena::m_flush(
+    uint_t cls
+) {
+    tcache_bin &bin = m_tcache()[cls];
+    const size_t keep = s_tcache_limit(cls) / 2;
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+    while (bin.count > keep) {
+        void *block = bin.head;
+        bin.head = block_next(block);
+        bin.count--;
+        block_next(block) = m_free[cls];
+        m_free[cls] = block;
+    }
+}
+
+void
+qvi_arena::m_flush_all(
+    tcache &tc
+) {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    for (uint_t cls = 0; cls < s_nclasses; ++cls) {
+        tcache_bin &bin = tc[cls];
+        while (bin.head) {
+            void *block = bin.head;
+            bin.head = block_next(block);
+            block_next(block) = m_free[cls];
+            m_free[cls] = block;
+        }
+        bin.count = 0;
+    }
+}
+
+int
+qvi_arena::m_large_alloc(
+    size_t size,
+    void **ptr
+) {
+    if (qvi_unlikely(size > SIZE_MAX / 2)) return QV_ERR_OOR;
+
+    size_t length = size + sizeof(qvi_arena_block);
+    void *addr = nullptr;
+    const int rc = m_map(length, &addr);
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+
+    qvi_arena_block *hdr = static_cast<qvi_arena_block *>(addr);
+    hdr->arena = this;
+    hdr->tag = length;
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_large.insert({addr, length});
+    }
+    *ptr = hdr + 1;
+    return QV_SUCCESS;
+}
+
+int
+qvi_arena::m_large_free(
+    void *block
+) {
+    const size_t length = static_cast<qvi_arena_block *>(block)->tag;
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        if (qvi_unlikely(m_large.erase(block) == 0)) return QV_ERR_INVLD_ARG;
+    }
+    munmap(block, length);
+    return QV_SUCCESS;
+}
+
+int
+qvi_arena::malloc(
+    size_t size,
+    void **ptr
+) {
+    *ptr = nullptr;
+
+    const size_t need = size + sizeof(qvi_arena_block);
+    if (size > s_class_size(s_nclasses - 1) - sizeof(qvi_arena_block)) {
+        return m_large_alloc(size, ptr);
+    }
+
+    uint_t cls = 0;
+    while (s_class_size(cls) < need) cls++;
+
+    tcache_bin &bin = m_tcache()[cls];
+    void *block = bin.head;
+    if (qvi_likely(block)) {
+        bin.head = block_next(block);
+        bin.count--;
+    }
+    else {
+        const int rc = m_refill(cls, &block);
+        if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+    }
+    *ptr = static_cast<qvi_arena_block *>(block) + 1;
+    return QV_SUCCESS;
+}
+
+int
+qvi_arena::free(
+    void *ptr
+) {
+    qvi_arena_block *hdr = static_cast<qvi_arena_block *>(ptr) - 1;
+    if (qvi_unlikely(hdr->arena != this)) return QV_ERR_INVLD_ARG;
+
+    if (hdr->tag >= s_nclasses) return m_large_free(hdr);
+
+    const uint_t cls = hdr->tag;
+    tcache_bin &bin = m_tcache()[cls];
+    block_next(hdr) = bin.head;
+    bin.head = hdr;
+    bin.count++;
+
+    if (qvi_unlikely(bin.count > s_tcache_limit(cls))) m_flush(cls);
+    return QV_SUCCESS;
+}
+
+/*
+ * vim: ft=cpp ts=4 sts=4 sw=4 expandtab
+ */
@@ -0,0 +1,159 @@
+/* -*- Mode: C++; c-basic-offset:4; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2025      Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the quo-vadis project. See the LICENSE file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * @file qvi-arena.h
+ *
+ * NUMA-local memory arenas backing qv_scope_malloc().
+ */
+
+#ifndef QVI_ARENA_H
+#define QVI_ARENA_H
+
+#include "qvi-common.h"
+#include "qvi-hwloc.h"
+
+/**
+ * A memory arena whose pages are bound to a set of NUMA nodes. Small requests
+ * are served from power-of-two size classes carved out of large mappings and
+ * recycled through per-thread free lists, so the common path takes no locks.
+ * Large requests get their own mapping.
+ */
+struct qvi_arena {
+private:
+    /** Number of size classes served from arena chunks. */
+    static constexpr uint_t s_nclasses = 15;
+    /** Block size of the smallest size class, including its header. */
+    static constexpr size_t s_min_class_size = 32;
+    /** Size of the mappings size classes are carved from. */
+    static constexpr size_t s_chunk_size = 4 * 1024 * 1024;
+    /** Huge page size assumed when mapping huge pages. */
+    static constexpr size_t s_huge_page_size = 2 * 1024 * 1024;
+    /** Approximate number of bytes a thread caches per size class. */
+    static constexpr size_t s_tcache_bytes = 1024 * 1024;
+    /** A per-thread free list for a single size class. */
+    struct tcache_bin {
+        void *head = nullptr;
+        size_t count = 0;
+    };
+    /** A thread's free lists for a single arena. */
+    using tcache = std::array<tcache_bin, s_nclasses>;
+    /**
+     * A thread's free lists for every arena it has used. Returns the cached
+     * blocks of live arenas when the thread exits.
+     */
+    struct tcache_set {
+        std::unordered_map<uint64_t, tcache> tcaches;
+        ~tcache_set(void);
+    };
+    /** Unique arena ID, used to key per-thread free lists. */
+    uint64_t m_id = 0;
+    /** Maintains hardware locality information. */
+    qvi_hwloc &m_hwloc;
+    /** The NUMA nodes backing this arena. */
+    qvi_hwloc_bitmap m_nodeset;
+    /** Whether mappings should use huge pages. */
+    bool m_huge_pages = false;
+    /** Protects the members below. */
+    std::mutex m_mutex;
+    /** Chunks carved into size classes. */
+    std::vector<std::pair<void *, size_t>> m_chunks;
+    /** Dedicated mappings of live large blocks. */
+    std::unordered_map<void *, size_t> m_large;
+    /** Next free byte in the current chunk. */
+    byte_t *m_cursor = nullptr;
+    /** End of the current chunk. */
+    byte_t *m_end = nullptr;
+    /** Shared free lists, one per size class. */
+    std::array<void *, s_nclasses> m_free = {};
+    /** Returns the block size of the provided size class. */
+    static size_t
+    s_class_size(
+        uint_t cls
+    );
+    /** Returns the number of blocks a thread caches for a size class. */
+    static size_t
+    s_tcache_limit(
+        uint_t cls
+    );
+    /** Returns the calling thread's free lists for this arena. */
+    tcache &
+    m_tcache(void);
+    /** Maps and binds a region of at least the provided length. */
+    int
+    m_map(
+        size_t &length,
+        void **addr
+    );
+    /** Returns a block of the provided size class, refilling tcache. */
+    int
+    m_refill(
+        uint_t cls,
+        void **block
+    );
+    /** Returns blocks from the calling thread's free list to the arena. */
+    void
+    m_flush(
+        uint_t cls
+    );
+    /** Returns all the blocks cached in the provided free lists. */
+    void
+    m_flush_all(
+        tcache &tc
+    );
+    /** Allocates a block with a dedicated mapping. */
+    int
+    m_large_alloc(
+        size_t size,
+        void **ptr
+    );
+    /** Releases a block with a dedicated mapping. */
+    int
+    m_large_free(
+        void *block
+    );
+public:
+    /** Constructor. */
+    qvi_arena(void) = delete;
+    /** Constructor. */
+    qvi_arena(
+        qvi_hwloc &hwloc,
+        const qvi_hwloc_bitmap &nodeset,
+        bool huge_pages
+    );
+    /** Copy constructor. */
+    qvi_arena(const qvi_arena &src) = delete;
+    /** Assignment operator. */
+    void
+    operator=(const qvi_arena &src) = delete;
+    /** Destructor. Unmaps all of the arena's memory. */
+    ~qvi_arena(void);
+    /** Returns the arena that owns the provided allocation. */
+    static qvi_arena *
+    owner(
+        void *ptr
+    );
+    /** Allocates size bytes of NUMA-local memory. */
+    int
+    malloc(
+        size_t size,
+        void **ptr
+    );
+    /** Frees memory allocated by this arena. */
+    int
+    free(
+        void *ptr
+    );
+};
+
+#endif
+
+/*
+ * vim: ft=cpp ts=4 sts=4 sw=4 expandtab
+ */
@@ -87,17 +87,65 @@ bcast(
     int rootid,
     TYPE &value
 ) {
-    static_assert(
-        std::is_trivially_copyable<TYPE>::value &&
-        !std::is_pointer<TYPE>::value, ""
-    );
+    static_assert(!std::is_pointer<TYPE>::value, "");
 
-    std::vector<TYPE> values;
+    qvi_bbuff buff;
+    int rc = QV_SUCCESS;
     if (group.rank() == rootid) {
-        values.resize(group.size());
-        std::fill(values.begin(), values.end(), value);
+        rc = buff.pack(value);
+        if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
     }
-    return qvi_coll::scatter(group, rootid, values, value);
+    rc = group.bcast(buff, rootid);
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+    // The root already has the value.
+    if (group.rank() == rootid) return QV_SUCCESS;
+    return qvi_bbuff::unpack(buff.data(), value);
+}
+
+template <typename TYPE>
+int
+allgather(
+    const qvi_group &group,
+    const TYPE &send,
+    std::vector<TYPE> &recv
+) {
+    qvi_bbuff txbuff;
+    int rc = txbuff.pack(send);
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+
+    std::vector<qvi_bbuff> rxbuffs;
+    rc = group.allgather(txbuff, rxbuffs);
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+
+    recv.resize(rxbuffs.size());
+    for (size_t i = 0; i < rxbuffs.size(); ++i) {
+        rc = qvi_bbuff::unpack(rxbuffs[i].data(), recv[i]);
+        if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+    }
+    return QV_SUCCESS;
+}
+
+/**
+ * Element-wise reduces the provided integral values
+ * across all members and returns the result to all.
+ */
+template <typename TYPE>
+int
+allreduce(
+    const qvi_group &group,
+    const std::vector<TYPE> &send,
+    qvi_group_op_t op,
+    std::vector<TYPE> &recv
+) {
+    static_assert(std::is_integral<TYPE>::value, "");
+
+    const std::vector<int64_t> isend(send.begin(), send.end());
+    std::vector<int64_t> irecv;
+    const int rc = group.allreduce(isend, op, irecv);
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+
+    recv.assign(irecv.begin(), irecv.end());
+    return QV_SUCCESS;
 }
 
 } // qvi_coll namespace
@@ -38,6 +38,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/resource.h>
 #include <sys/stat.h>
 #include <sys/syscall.h>
@@ -50,6 +51,7 @@
 #include "qvi-log.h"
 #include <chrono>
 #include <csignal>
+#include <deque>
 #include <filesystem>
 #include <fstream>
 #include <list>
@@ -58,6 +60,7 @@
 #include <condition_variable>
 #include <new>
 #include <numeric>
+#include <queue>
 #include <random>
 #include <regex>
 #include <set>
@@ -95,6 +98,14 @@ static const std::string QVI_ENV_PORT = "QV_PORT";
 static const std::string QVI_ENV_TMPDIR = "QV_TMPDIR";
 /** Verbose exceptions environment variable name. */
 static const std::string QVI_ENV_VEXCEPT = "QV_VEXCEPT";
+/** Full client topology environment variable name. */
+static const std::string QVI_ENV_CLIENT_TOPOLOGY_FULL = "QV_CLIENT_TOPOLOGY_FULL";
+/** Barrier spin duration (in microseconds) environment variable name. */
+static const std::string QVI_ENV_BARRIER_SPIN_US = "QV_BARRIER_SPIN_US";
+/** Barrier maximum sleep (in microseconds) environment variable name. */
+static const std::string QVI_ENV_BARRIER_MAX_SLEEP_US = "QV_BARRIER_MAX_SLEEP_US";
+/** Low-noise barrier environment variable name. */
+static const std::string QVI_ENV_BARRIER_LOW_NOISE = "QV_BARRIER_LOW_NOISE";
 
 /**
  * Quo Vadis runtime error.
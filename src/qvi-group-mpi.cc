@@ -22,10 +22,19 @@ qvi_group_mpi::qvi_group_mpi(
     qvi_mpi *mpi_ctx
 ) {
     if (qvi_unlikely(!mpi_ctx)) throw qvi_runtime_error(QV_ERR_INTERNAL);
-    m_mpi = mpi_ctx;
 
     const int rc = m_task.connect_to_server();
     if (qvi_unlikely(rc != QV_SUCCESS)) throw qvi_runtime_error(rc);
+    // Keep the context around for as long as we need it.
+    m_mpi = mpi_ctx;
+    m_mpi->retain();
+}
+
+qvi_group_mpi::~qvi_group_mpi(void)
+{
+    if (!m_mpi) return;
+    m_mpi->release_group(m_mpi_group);
+    m_mpi->release();
 }
 
 int
@@ -27,7 +27,7 @@ struct qvi_group_mpi : public qvi_group {
 protected:
     /** Task associated with this group. */
     qvi_task m_task;
-    /** Points to the base MPI context information. */
+    /** Points to the base MPI context information, which we retain. */
     qvi_mpi *m_mpi = nullptr;
     /** Underlying group instance. */
     qvi_mpi_group m_mpi_group;
@@ -39,7 +39,7 @@ public:
         qvi_mpi *mpi_ctx
     );
     /** Destructor. */
-    virtual ~qvi_group_mpi(void) = default;
+    virtual ~qvi_group_mpi(void);
 
     virtual qvi_task &
     task(void)
@@ -109,6 +109,31 @@ public:
             txbuffs, root, rxbuff
         );
     }
+
+    virtual int
+    bcast(
+        qvi_bbuff &buff,
+        int root
+    ) const {
+        return m_mpi_group.bcast_bbuff(buff, root);
+    }
+
+    virtual int
+    allgather(
+        const qvi_bbuff &txbuff,
+        std::vector<qvi_bbuff> &rxbuffs
+    ) const {
+        return m_mpi_group.allgather_bbuffs(txbuff, rxbuffs);
+    }
+
+    virtual int
+    allreduce(
+        const std::vector<int64_t> &send,
+        qvi_group_op_t op,
+        std::vector<int64_t> &recv
+    ) const {
+        return m_mpi_group.allreduce(send, op, recv);
+    }
     /** Returns a duplicate of the underlying MPI group communicator. */
     int
     comm_dup(
@@ -133,10 +158,7 @@ struct qvi_zgroup_mpi : public qvi_group_mpi {
         if (qvi_unlikely(rc != QV_SUCCESS)) throw qvi_runtime_error(rc);
     }
     /** Destructor. */
-    virtual ~qvi_zgroup_mpi(void)
-    {
-        qvi_delete(&m_mpi);
-    }
+    virtual ~qvi_zgroup_mpi(void) = default;
 };
 
 #endif
@@ -135,6 +135,39 @@ public:
         rxbuff = txbuffs[root];
         return QV_SUCCESS;
     }
+
+    virtual int
+    bcast(
+        qvi_bbuff &,
+        int root
+    ) const {
+        // Make sure that we are dealing with a valid process group.
+        // If not, this is an internal development error, so abort.
+        if (qvi_unlikely(root != 0 || size() != 1)) qvi_abort();
+        // The root (us) already has the data.
+        return QV_SUCCESS;
+    }
+
+    virtual int
+    allgather(
+        const qvi_bbuff &txbuff,
+        std::vector<qvi_bbuff> &rxbuffs
+    ) const {
+        rxbuffs.resize(size());
+        rxbuffs[0] = txbuff;
+        return QV_SUCCESS;
+    }
+
+    virtual int
+    allreduce(
+        const std::vector<int64_t> &send,
+        qvi_group_op_t,
+        std::vector<int64_t> &recv
+    ) const {
+        // The reduction of a single member's values is those values.
+        recv = send;
+        return QV_SUCCESS;
+    }
 };
 
 #endif
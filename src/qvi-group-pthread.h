@@ -21,14 +21,11 @@ typedef void *(*qvi_pthread_routine_fun_ptr_t)(void *);
 struct qvi_group_pthread : public qvi_group_thread {
     /** Default constructor. */
     qvi_group_pthread(void) = delete;
-    /**
-     * Constructor that is called by the parent process to setup
-     * base infrastructure required during a thread_split().
-     */
+    /** Constructor. */
     qvi_group_pthread(
-        int group_size,
-        const std::vector<int> &colors
-    ) : qvi_group_thread(group_size, colors) { }
+        const std::shared_ptr<qvi_group_thread_team> &team,
+        int rank
+    ) : qvi_group_thread(team, rank) { }
     /** Destructor. */
     virtual ~qvi_group_pthread(void) = default;
     /** */
@@ -0,0 +1,285 @@
+/* -*- Mode: C++; c-basic-offset:4; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c)      2025 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the quo-vadis project. See the LICENSE file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * @file qvi-group-thread.cc
+ */
+
+#include "qvi-group-thread.h"
+#include "qvi-utils.h"
+
+qvi_group_thread_tasks::qvi_group_thread_tasks(
+    int ntasks
+) : m_tasks(ntasks)
+{
+    static std::atomic<uint64_t> next_id(1);
+    m_id = next_id.fetch_add(1);
+    // A power of two, so probing wraps with a mask.
+    size_t size = 16;
+    while (size < ntasks * s_tid2index_per_task) size *= 2;
+    m_tid2index = std::vector<std::atomic<uint64_t>>(size);
+    // Initialize the tasks.
+    for (auto &task : m_tasks) {
+        const int rc = task.connect_to_server();
+        if (qvi_unlikely(rc != QV_SUCCESS)) throw qvi_runtime_error(rc);
+    }
+}
+
+size_t
+qvi_group_thread_tasks::m_index(
+    pid_t tid
+) {
+    const uint64_t utid = uint32_t(tid);
+    const size_t mask = m_tid2index.size() - 1;
+    size_t pos = ((utid * 0x9e3779b97f4a7c15ULL) >> 32) & mask;
+    // Assigned when we first find an empty entry.
+    size_t index = 0;
+    bool assigned = false;
+
+    for (size_t probe = 0; probe <= mask; ++probe, pos = (pos + 1) & mask) {
+        uint64_t entry = m_tid2index[pos].load(std::memory_order_acquire);
+        if (entry == 0) {
+            if (!assigned) {
+                index = m_next_index.fetch_add(1) % m_tasks.size();
+                assigned = true;
+            }
+            const uint64_t mine = (utid << 32) | (index + 1);
+            if (m_tid2index[pos].compare_exchange_strong(
+                    entry, mine, std::memory_order_acq_rel
+            )) return index;
+            // Another thread claimed it first, so keep probing.
+        }
+        if ((entry >> 32) == utid) return (entry & 0xffffffff) - 1;
+    }
+    // The table is full, so fall back to the slower overflow map. A thread
+    // must keep its task, since the task holds the thread's binding stack.
+    std::lock_guard<std::mutex> guard(m_overflow_mutex);
+    const auto got = m_tid2index_overflow.find(tid);
+    if (got != m_tid2index_overflow.end()) return got->second;
+
+    if (!assigned) index = m_next_index.fetch_add(1) % m_tasks.size();
+    m_tid2index_overflow.insert({tid, index});
+    return index;
+}
+
+qvi_task &
+qvi_group_thread_tasks::task(void)
+{
+    // Threads tend to ask repeatedly, so remember the last answer. Keyed by
+    // instance ID rather than address so that a new instance never sees the
+    // answer left behind by a destroyed one.
+    static thread_local uint64_t last_id = 0;
+    static thread_local size_t last_index = 0;
+
+    if (qvi_unlikely(last_id != m_id)) {
+        last_index = m_index(qvi_gettid());
+        last_id = m_id;
+    }
+    return m_tasks[last_index];
+}
+
+qvi_hwloc &
+qvi_group_thread_tasks::hwloc(void)
+{
+    // The tasks share the same topology.
+    return m_tasks.front().hwloc();
+}
+
+void
+qvi_group_thread_team::barrier(void)
+{
+    // The generation cannot advance before we arrive.
+    const uint64_t gen = generation.load(std::memory_order_acquire);
+    if (arrived.fetch_add(1, std::memory_order_acq_rel) == size - 1) {
+        // Last to arrive, so reset for the next barrier and release everyone.
+        arrived.store(0, std::memory_order_relaxed);
+        generation.fetch_add(1, std::memory_order_release);
+        return;
+    }
+    qvi_wait_until([&] {
+        return generation.load(std::memory_order_acquire) != gen;
+    });
+}
+
+int
+qvi_group_thread::create_members(
+    int nthreads,
+    std::vector<qvi_group *> &members
+) {
+    members.clear();
+
+    std::shared_ptr<qvi_group_thread_team> team;
+    try {
+        team = std::make_shared<qvi_group_thread_team>(
+            nthreads, std::make_shared<qvi_group_thread_tasks>(nthreads)
+        );
+    }
+    qvi_catch_and_return();
+
+    for (int rank = 0; rank < nthreads; ++rank) {
+        qvi_group_thread *member = nullptr;
+        const int rc = qvi_new(&member, team, rank);
+        if (qvi_unlikely(rc != QV_SUCCESS)) {
+            for (auto &imember : members) {
+                qvi_delete(&imember);
+            }
+            members.clear();
+            return rc;
+        }
+        members.push_back(member);
+    }
+    return QV_SUCCESS;
+}
+
+// The collectives below exchange pointers to the members' data through the
+// team's slots, so data are copied once and never serialized. Each ends with
+// a barrier, so the data outlive their readers and the slots are not reused
+// before everyone is done with them.
+
+int
+qvi_group_thread::split(
+    int color,
+    int key,
+    qvi_group **child
+) {
+    *child = nullptr;
+    qvi_group_thread_team &team = *m_team;
+
+    qvi_subgroup_color_key_rank &mine = team.ckrs[m_rank];
+    mine.color = color;
+    mine.key = key;
+    mine.rank = m_rank;
+    team.barrier();
+    // Order the members of our color by key, then by rank.
+    std::vector<qvi_subgroup_color_key_rank> members;
+    for (const auto &ckr : team.ckrs) {
+        if (ckr.color == color) members.push_back(ckr);
+    }
+    std::sort(
+        members.begin(), members.end(),
+        qvi_subgroup_color_key_rank::by_color_key_rank
+    );
+    int child_rank = 0;
+    while (members[child_rank].rank != m_rank) child_rank++;
+    // The first member creates the child team. Its tasks are ours.
+    const int leader = members.front().rank;
+    int rc = QV_SUCCESS;
+    if (m_rank == leader) {
+        try {
+            team.children[leader] = std::make_shared<qvi_group_thread_team>(
+                int(members.size()), team.tasks
+            );
+        }
+        catch (const std::exception &) {
+            team.children[leader] = nullptr;
+        }
+    }
+    team.barrier();
+
+    const std::shared_ptr<qvi_group_thread_team> child_team =
+        team.children[leader];
+    if (qvi_unlikely(!child_team)) rc = QV_ERR_OOR;
+
+    qvi_group_thread *ichild = nullptr;
+    if (qvi_likely(rc == QV_SUCCESS)) {
+        rc = qvi_new(&ichild, child_team, child_rank);
+    }
+    team.barrier();
+    // Drop the team's reference, so the child team
+    // only lives as long as its members.
+    if (m_rank == leader) team.children[leader] = nullptr;
+
+    *child = ichild;
+    return rc;
+}
+
+int
+qvi_group_thread::gather(
+    const qvi_bbuff &txbuff,
+    int root,
+    std::vector<qvi_bbuff> &rxbuffs
+) const {
+    qvi_group_thread_team &team = *m_team;
+
+    team.slots[m_rank] = &txbuff;
+    team.barrier();
+
+    if (m_rank == root) {
+        rxbuffs.clear();
+        rxbuffs.reserve(team.size);
+        for (const void *slot : team.slots) {
+            rxbuffs.push_back(*static_cast<const qvi_bbuff *>(slot));
+        }
+    }
+    team.barrier();
+    return QV_SUCCESS;
+}
+
+int
+qvi_group_thread::scatter(
+    const std::vector<qvi_bbuff> &txbuffs,
+    int root,
+    qvi_bbuff &rxbuff
+) const {
+    qvi_group_thread_team &team = *m_team;
+
+    if (m_rank == root) {
+        team.slots[root] = &txbuffs;
+    }
+    team.barrier();
+
+    const auto &rootbuffs = *static_cast<
+        const std::vector<qvi_bbuff> *
+    >(team.slots[root]);
+    rxbuff = rootbuffs.at(m_rank);
+    team.barrier();
+    return QV_SUCCESS;
+}
+
+int
+qvi_group_thread::bcast(
+    qvi_bbuff &buff,
+    int root
+) const {
+    qvi_group_thread_team &team = *m_team;
+
+    if (m_rank == root) {
+        team.slots[root] = &buff;
+    }
+    team.barrier();
+
+    if (m_rank != root) {
+        buff = *static_cast<const qvi_bbuff *>(team.slots[root]);
+    }
+    team.barrier();
+    return QV_SUCCESS;
+}
+
+int
+qvi_group_thread::allgather(
+    const qvi_bbuff &txbuff,
+    std::vector<qvi_bbuff> &rxbuffs
+) const {
+    qvi_group_thread_team &team = *m_team;
+
+    team.slots[m_rank] = &txbuff;
+    team.barrier();
+
+    rxbuffs.clear();
+    rxbuffs.reserve(team.size);
+    for (const void *slot : team.slots) {
+        rxbuffs.push_back(*static_cast<const qvi_bbuff *>(slot));
+    }
+    team.barrier();
+    return QV_SUCCESS;
+}
+
+/*
+ * vim: ft=cpp ts=4 sts=4 sw=4 expandtab
+ */
@@ -17,79 +17,145 @@
 #include "qvi-common.h"
 #include "qvi-group.h"
 #include "qvi-task.h"
+#include "qvi-subgroup.h"
 
 /**
- * Base thread group class.
+ * Tasks shared by the members of a thread group and the groups split from it.
  */
-struct qvi_group_thread : qvi_group {
+struct qvi_group_thread_tasks {
 private:
-    /** Used for mutexy things. */
-    std::mutex m_mutex;
+    /** Number of TID table entries per task. */
+    static constexpr size_t s_tid2index_per_task = 8;
+    /** Unique instance ID. */
+    uint64_t m_id = 0;
     /** Holds the appropriate number of task instances. */
     std::vector<qvi_task> m_tasks;
-    //
-    qvi_lru_cache<pid_t, size_t> m_tid2index;
+    /** Index of the task handed to the next new thread. */
+    std::atomic<size_t> m_next_index = {0};
+    /**
+     * Lock-free, open-addressing table mapping TIDs to task indices. Each
+     * entry packs a TID with its index plus one, so that it is claimed with
+     * a single compare-and-swap. Zero marks an empty entry. It holds eight
+     * entries per task, and the TIDs of any threads beyond that go to
+     * m_tid2index_overflow.
+     */
+    std::vector<std::atomic<uint64_t>> m_tid2index;
+    /** Serializes access to m_tid2index_overflow. */
+    std::mutex m_overflow_mutex;
+    /** Maps the TIDs that did not fit in m_tid2index to task indices. */
+    std::unordered_map<pid_t, size_t> m_tid2index_overflow;
+    /** Returns the index of the provided thread's task, assigning one. */
+    size_t
+    m_index(
+        pid_t tid
+    );
+public:
+    /** Deleted default constructor. */
+    qvi_group_thread_tasks(void) = delete;
+    /** Constructor. */
+    qvi_group_thread_tasks(
+        int ntasks
+    );
+    /**
+     * This implements a dynamic, transient TID mapping to tasks. This is geared
+     * for runtimes like OpenMP where respective parallel regions may spawn new
+     * threads.
+     */
+    qvi_task &
+    task(void);
+    /**
+     * Returns the tasks' hwloc information. Unlike task(), this does not
+     * assign the calling thread a task, so it may be called by a thread that
+     * is not a member, like the one creating the members' threads.
+     */
+    qvi_hwloc &
+    hwloc(void);
+};
+
+/**
+ * State shared by the members of a thread group, through
+ * which they synchronize and exchange data in place.
+ */
+struct qvi_group_thread_team {
+    /** Number of members. */
+    const int size;
+    /** The members' tasks. */
+    std::shared_ptr<qvi_group_thread_tasks> tasks;
+    /** Number of members that arrived at the current barrier. */
+    alignas(64) std::atomic<int> arrived = {0};
+    /** Number of completed barriers. */
+    alignas(64) std::atomic<uint64_t> generation = {0};
+    /** Per-member pointers to the data of the current collective. */
+    std::vector<const void *> slots;
+    /** Per-member colors and keys of the current split. */
+    std::vector<qvi_subgroup_color_key_rank> ckrs;
+    /** Per-member child teams of the current split. */
+    std::vector<std::shared_ptr<qvi_group_thread_team>> children;
+    /** Deleted default constructor. */
+    qvi_group_thread_team(void) = delete;
+    /** Constructor. */
+    qvi_group_thread_team(
+        int size_a,
+        const std::shared_ptr<qvi_group_thread_tasks> &tasks_a
+    ) : size(size_a)
+      , tasks(tasks_a)
+      , slots(size_a, nullptr)
+      , ckrs(size_a)
+      , children(size_a) { }
+    /** Waits until every member has called barrier. */
+    void
+    barrier(void);
+};
+
+/**
+ * Base thread group class. Every member has its own instance, which shares
+ * its team with the other members.
+ */
+struct qvi_group_thread : qvi_group {
+private:
+    /** The team this member belongs to. */
+    std::shared_ptr<qvi_group_thread_team> m_team;
+    /** The member's rank in its team. */
+    int m_rank = 0;
 public:
     /** Deleted default constructor. */
     qvi_group_thread(void) = delete;
     /** Constructor. */
     qvi_group_thread(
-        int nthreads,
-        const std::vector<int> &
-    ) : m_tasks(nthreads)
-      , m_tid2index(nthreads * 8) {
-        // Note the unused vector of ints are colors. We don't currently use
-        // that information because we don't support group splits within a
-        // threaded context, so ignore it. See qvi_group::thread_split().
-
-        // Initialize the tasks.
-        for (auto &task : m_tasks) {
-            const int rc = task.connect_to_server();
-            if (qvi_unlikely(rc != QV_SUCCESS)) throw qvi_runtime_error(rc);
-        }
-    }
+        const std::shared_ptr<qvi_group_thread_team> &team,
+        int rank
+    ) : m_team(team)
+      , m_rank(rank) { }
     /** Virtual destructor. */
     virtual ~qvi_group_thread(void) = default;
     /**
-     * This implements a dynamic, transient TID mapping to tasks. This is geared
-     * for runtimes like OpenMP where respective parallel regions may spawn new
-     * threads.
+     * Creates the members of a new thread group
+     * with nthreads members, in rank order.
      */
+    static int
+    create_members(
+        int nthreads,
+        std::vector<qvi_group *> &members
+    );
+
     virtual qvi_task &
     task(void) {
-        static std::atomic<size_t> next_index(0);
-        const pid_t mytid = qvi_gettid();
-
-        std::lock_guard<std::mutex> guard(m_mutex);
-
-        size_t myindex = 0;
-        const int rc = m_tid2index.get(mytid, myindex);
-
-        switch (rc) {
-            // Found my index.
-            case QV_SUCCESS:
-                break;
-            // Not found, so create new index and cache it.
-            case QV_ERR_NOT_FOUND:
-                myindex = next_index++ % m_tasks.size();
-                m_tid2index.put(mytid, myindex);
-                break;
-            default:
-                throw qvi_runtime_error(QV_ERR_INVLD_ARG);
-        }
-        return m_tasks.at(myindex);
+        return m_team->tasks->task();
+    }
+
+    virtual qvi_hwloc &
+    hwloc(void) {
+        return m_team->tasks->hwloc();
     }
 
     virtual int
     size(void) const {
-        // By default thread groups do not support this operation.
-        return QV_ERR_NOT_SUPPORTED;
+        return m_team->size;
     }
 
     virtual int
     rank(void) const {
-        // By default thread groups do not support this operation.
-        return QV_ERR_NOT_SUPPORTED;
+        return m_rank;
     }
 
     virtual std::vector<pid_t>
@@ -105,8 +171,8 @@ public:
 
     virtual int
     barrier(void) const {
-        // By default thread groups do not support this operation.
-        return QV_ERR_NOT_SUPPORTED;
+        m_team->barrier();
+        return QV_SUCCESS;
     }
 
     virtual int
@@ -132,8 +198,7 @@ public:
     virtual int
     thread_split(
         int,
-        const std::vector<int> &,
-        qvi_group **
+        std::vector<qvi_group *> &
     ) {
         // By default thread groups do not support this operation.
         return QV_ERR_NOT_SUPPORTED;
@@ -141,33 +206,36 @@ public:
 
     virtual int
     split(
-        int,
-        int,
-        qvi_group **
-    ) {
-        // By default thread groups do not support this operation.
-        return QV_ERR_NOT_SUPPORTED;
-    }
+        int color,
+        int key,
+        qvi_group **child
+    );
 
     virtual int
     gather(
-        const qvi_bbuff &,
-        int,
-        std::vector<qvi_bbuff> &
-    ) const {
-        // By default thread groups do not support this operation.
-        return QV_ERR_NOT_SUPPORTED;
-    }
+        const qvi_bbuff &txbuff,
+        int root,
+        std::vector<qvi_bbuff> &rxbuffs
+    ) const;
 
     virtual int
     scatter(
-        const std::vector<qvi_bbuff> &,
-        int,
-        qvi_bbuff &
-    ) const {
-        // By default thread groups do not support this operation.
-        return QV_ERR_NOT_SUPPORTED;
-    }
+        const std::vector<qvi_bbuff> &txbuffs,
+        int root,
+        qvi_bbuff &rxbuff
+    ) const;
+
+    virtual int
+    bcast(
+        qvi_bbuff &buff,
+        int root
+    ) const;
+
+    virtual int
+    allgather(
+        const qvi_bbuff &txbuff,
+        std::vector<qvi_bbuff> &rxbuffs
+    ) const;
 };
 
 #endif
@@ -25,18 +25,117 @@ qvi_group::hwloc(void)
 int
 qvi_group::thread_split(
     int nthreads,
-    const std::vector<int> &colors,
-    qvi_group **child
+    std::vector<qvi_group *> &children
 ) {
     // This is the entry point for creating a new thread group. Also note this is
-    // called by a single thread of execution (i.e., the parent process).
-    qvi_group_thread *ichild = nullptr;
-    const int rc = qvi_new(&ichild, nthreads, colors);
-    if (qvi_unlikely(rc != QV_SUCCESS)) {
-        qvi_delete(&ichild);
+    // called by a single thread of execution (i.e., the parent process). Every
+    // thread belongs to the new group. Threads can split it further by color
+    // with split().
+    return qvi_group_thread::create_members(nthreads, children);
+}
+
+int
+qvi_group::bcast(
+    qvi_bbuff &buff,
+    int root
+) const {
+    std::vector<qvi_bbuff> txbuffs;
+    if (rank() == root) {
+        txbuffs.resize(size(), buff);
+    }
+    qvi_bbuff rxbuff;
+    const int rc = scatter(txbuffs, root, rxbuff);
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+
+    if (rank() != root) {
+        buff = rxbuff;
+    }
+    return QV_SUCCESS;
+}
+
+int
+qvi_group::allgather(
+    const qvi_bbuff &txbuff,
+    std::vector<qvi_bbuff> &rxbuffs
+) const {
+    static constexpr int root = 0;
+
+    int rc = gather(txbuff, root, rxbuffs);
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+    // Flatten the gathered buffers, each prefixed by its size.
+    qvi_bbuff all;
+    if (rank() == root) {
+        for (const auto &rxbuff : rxbuffs) {
+            const size_t len = rxbuff.size();
+            rc = all.append(&len, sizeof(len));
+            if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+            rc = all.append(rxbuff.cdata(), len);
+            if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+        }
     }
-    *child = ichild;
-    return rc;
+    rc = bcast(all, root);
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+
+    if (rank() != root) {
+        rxbuffs.clear();
+        rxbuffs.resize(size());
+        const byte_t *pos = static_cast<const byte_t *>(all.cdata());
+        for (auto &rxbuff : rxbuffs) {
+            size_t len = 0;
+            memmove(&len, pos, sizeof(len));
+            pos += sizeof(len);
+            rc = rxbuff.append(pos, len);
+            if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+            pos += len;
+        }
+    }
+    return QV_SUCCESS;
+}
+
+int
+qvi_group::allreduce(
+    const std::vector<int64_t> &send,
+    qvi_group_op_t op,
+    std::vector<int64_t> &recv
+) const {
+    qvi_bbuff txbuff;
+    int rc = txbuff.pack(send);
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+
+    std::vector<qvi_bbuff> rxbuffs;
+    rc = allgather(txbuff, rxbuffs);
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+
+    recv = send;
+    std::vector<int64_t> values;
+    for (int i = 0; i < size(); ++i) {
+        rc = qvi_bbuff::unpack(rxbuffs[i].data(), values);
+        if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+        if (qvi_unlikely(values.size() != send.size())) {
+            return QV_ERR_INTERNAL;
+        }
+        // Reduce in rank order so that every member gets the same result.
+        for (size_t j = 0; j < values.size(); ++j) {
+            if (i == 0) {
+                recv[j] = values[j];
+                continue;
+            }
+            switch (op) {
+                case QVI_GROUP_OP_MIN:
+                    recv[j] = std::min(recv[j], values[j]);
+                    break;
+                case QVI_GROUP_OP_MAX:
+                    recv[j] = std::max(recv[j], values[j]);
+                    break;
+                case QVI_GROUP_OP_SUM:
+                    recv[j] += values[j];
+                    break;
+                default:
+                    return QV_ERR_INVLD_ARG;
+            }
+        }
+    }
+    return QV_SUCCESS;
 }
 
 int
@@ -24,6 +24,13 @@
 /** Group ID type. */
 using qvi_group_id_t = uint64_t;
 
+/** Reduction operations supported by group collectives. */
+enum qvi_group_op_t {
+    QVI_GROUP_OP_MIN = 0,
+    QVI_GROUP_OP_MAX,
+    QVI_GROUP_OP_SUM
+};
+
 /**
  * Virtual base group class. Notice that groups are reference counted.
  */
@@ -33,7 +40,7 @@ struct qvi_group : qvi_refc {
     /** Virtual destructor. */
     virtual ~qvi_group(void) = default;
     /** Returns a reference to the task's hwloc information. */
-    qvi_hwloc &
+    virtual qvi_hwloc &
     hwloc(void);
     /** Returns a reference to the caller's task information. */
     virtual qvi_task &
@@ -66,13 +73,12 @@ struct qvi_group : qvi_refc {
     ) = 0;
     /**
      * Creates a new thread group by splitting off of the calling process'
-     * group.
+     * group. Returns the new group's members in rank order, one per thread.
      */
     virtual int
     thread_split(
         int nthreads,
-        const std::vector<int> &colors,
-        qvi_group **child
+        std::vector<qvi_group *> &children
     );
     /**
      * Creates new groups by splitting this group based on color, key.
@@ -98,6 +104,34 @@ struct qvi_group : qvi_refc {
         int root,
         qvi_bbuff &rxbuff
     ) const = 0;
+    /**
+     * Broadcasts a bbuff from the specified root. By default this
+     * scatters copies of the root's bbuff.
+     */
+    virtual int
+    bcast(
+        qvi_bbuff &buff,
+        int root
+    ) const;
+    /**
+     * Gathers bbuffs from all members to all members. By default this
+     * gathers to the first member and broadcasts the result.
+     */
+    virtual int
+    allgather(
+        const qvi_bbuff &txbuff,
+        std::vector<qvi_bbuff> &rxbuffs
+    ) const;
+    /**
+     * Element-wise reduces the provided values across all members and returns
+     * the result to all members. By default this is built on allgather.
+     */
+    virtual int
+    allreduce(
+        const std::vector<int64_t> &send,
+        qvi_group_op_t op,
+        std::vector<int64_t> &recv
+    ) const;
     /** Returns a unique group ID after each call. */
     static int
     next_id(
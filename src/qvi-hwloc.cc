@@ -20,6 +20,8 @@
 #include "qvi-nvml.h"
 #include "qvi-rsmi.h"
 
+#include "hwloc/glibc-sched.h"
+
 /** Maps a string identifier to a device. */
 using qvi_hwloc_dev_map = std::unordered_map<
     std::string,
@@ -35,13 +37,35 @@ dev_list_compare_by_visdev_id(
 }
 
 /**
- * Converts the provided hwloc object type to its corresponding internal type.
+ * Converts the provided hwloc OS device type to its corresponding internal
+ * type. Returns QV_HW_OBJ_LAST for OS devices we do not track.
+ */
+static qv_hw_obj_type_t
+osdev_hwloc2qv(
+    hwloc_obj_osdev_type_t external
+) {
+    switch (external) {
+        // For our purposes a HWLOC_OBJ_OSDEV_COPROC
+        // is the same as a HWLOC_OBJ_OSDEV_GPU.
+        case HWLOC_OBJ_OSDEV_GPU:
+        case HWLOC_OBJ_OSDEV_COPROC:
+            return QV_HW_OBJ_GPU;
+        case HWLOC_OBJ_OSDEV_OPENFABRICS:
+            return QV_HW_OBJ_NIC;
+        default:
+            return QV_HW_OBJ_LAST;
+    }
+}
+
+/**
+ * Converts the provided hwloc object's type to its corresponding internal
+ * type. Returns QV_HW_OBJ_LAST for OS devices we do not track.
  */
 static qv_hw_obj_type_t
 obj_hwloc2qv(
-   hwloc_obj_type_t external
+   hwloc_obj_t obj
 ) {
-    switch(external) {
+    switch(obj->type) {
         case(HWLOC_OBJ_MACHINE):
              return QV_HW_OBJ_MACHINE;
         case(HWLOC_OBJ_PACKAGE):
@@ -62,8 +86,12 @@ obj_hwloc2qv(
              return QV_HW_OBJ_L5CACHE;
         case(HWLOC_OBJ_NUMANODE):
             return QV_HW_OBJ_NUMANODE;
+        case(HWLOC_OBJ_DIE):
+            return QV_HW_OBJ_DIE;
+        case(HWLOC_OBJ_GROUP):
+            return QV_HW_OBJ_GROUP;
         case(HWLOC_OBJ_OS_DEVICE):
-            return QV_HW_OBJ_GPU;
+            return osdev_hwloc2qv(obj->attr->osdev.type);
         default:
             // This is an internal development error.
             qvi_abort();
@@ -287,6 +315,78 @@ qvi_hwloc::bitmap_split_by_chunk_id(
     );
 }
 
+int
+qvi_hwloc::bitmap_split_hierarchical(
+    hwloc_const_cpuset_t bitmap,
+    uint_t npieces,
+    qvi_hwloc_bitmaps &result
+) {
+    result.clear();
+    // Each piece needs at least one PU.
+    const int npus = hwloc_bitmap_weight(bitmap);
+    if (npieces == 0 || npus < 0 || uint_t(npus) < npieces) {
+        return QV_ERR_SPLIT;
+    }
+    // The cpuset's PUs in hardware tree order.
+    std::vector<hwloc_obj_t> pus;
+    hwloc_obj_t pu = nullptr;
+    while ((pu = hwloc_get_next_obj_inside_cpuset_by_type(
+                m_topo, bitmap, HWLOC_OBJ_PU, pu))) {
+        pus.push_back(pu);
+    }
+    const uint_t n = pus.size();
+    if (n < npieces) return QV_ERR_SPLIT;
+    // Pieces hold q or q + 1 consecutive PUs, r of them holding q + 1, so
+    // the ith cut, with j larger pieces before it, falls after i * q + j PUs.
+    // Choose where the larger pieces go so the cuts split as few objects as
+    // possible.
+    const uint_t q = n / npieces, r = n % npieces;
+    std::vector<uint_t> cut_costs(n, 0);
+    for (uint_t p = 1; p < n; ++p) {
+        cut_costs[p] = m_cut_cost(pus[p - 1], pus[p]);
+    }
+    // costs[j]: least cost of the cuts so far with j larger pieces.
+    std::vector<uint64_t> costs(r + 1, UINT64_MAX), next(r + 1);
+    costs[0] = 0;
+    // larger[i][j]: whether piece i is a larger one on the best path to j.
+    std::vector<std::vector<bool>> larger(
+        npieces, std::vector<bool>(r + 1, false)
+    );
+    for (uint_t i = 1; i <= npieces; ++i) {
+        std::fill(next.begin(), next.end(), UINT64_MAX);
+        for (uint_t j = 0; j <= std::min(i, r); ++j) {
+            // Leave room for the smaller pieces still to come.
+            if (i - j > npieces - r) continue;
+            uint64_t best = costs[j];
+            if (j > 0 && costs[j - 1] < best) {
+                best = costs[j - 1];
+                larger[i - 1][j] = true;
+            }
+            if (best == UINT64_MAX) continue;
+            const uint_t end = i * q + j;
+            next[j] = best + (end < n ? cut_costs[end] : 0);
+        }
+        std::swap(costs, next);
+    }
+    uint_t first = n;
+    for (uint_t i = npieces, j = r; i > 0; --i) {
+        const bool big = larger[i - 1][j];
+        first -= q + big;
+        j -= big;
+        qvi_hwloc_bitmap piece;
+        for (uint_t p = first; p < first + q + big; ++p) {
+            if (hwloc_bitmap_or(
+                    piece.data(), piece.cdata(), pus[p]->cpuset) != 0) {
+                result.clear();
+                return QV_ERR_HWLOC;
+            }
+        }
+        result.push_back(piece);
+    }
+    std::reverse(result.begin(), result.end());
+    return QV_SUCCESS;
+}
+
 qvi_hwloc::~qvi_hwloc(void)
 {
     if (m_topo) hwloc_topology_destroy(m_topo);
@@ -304,22 +404,39 @@ qvi_hwloc::m_topo_set_from_xml(
     return QV_SUCCESS;
 }
 
+int
+qvi_hwloc::m_topo_set_from_synthetic(
+    const std::string &description
+) {
+    const int rc = hwloc_topology_set_synthetic(m_topo, description.c_str());
+    if (qvi_unlikely(rc == -1)) {
+        qvi_log_error("hwloc_topology_set_synthetic() failed ({})", description);
+        return QV_ERR_HWLOC;
+    }
+    return QV_SUCCESS;
+}
+
 int
 qvi_hwloc::topology_init(
-    const std::string &xml_path
+    const std::string &xml_path,
+    const std::string &synthetic
 ) {
     const int rc = hwloc_topology_init(&m_topo);
     if (qvi_unlikely(rc != 0)) {
         qvi_log_error("hwloc_topology_init() failed");
         return QV_ERR_HWLOC;
     }
-    if (!xml_path.empty()) return m_topo_set_from_xml(xml_path);
-    return QV_SUCCESS;
+    if (!synthetic.empty()) return m_topo_set_from_synthetic(synthetic);
+    if (xml_path.empty()) return QV_SUCCESS;
+
+    m_topo_from_local_xml = true;
+    return m_topo_set_from_xml(xml_path);
 }
 
 int
-qvi_hwloc::topology_load(void)
-{
+qvi_hwloc::topology_load(
+    bool lean
+) {
     int rc = QV_SUCCESS;
     cstr_t ers = nullptr;
     do {
@@ -327,7 +444,13 @@ qvi_hwloc::topology_load(void)
         // not allowed (e.g., by cgroups) in the base topology. We will have
         // functions that provide bitmap access to allowed and disallowed
         // resources depending on need, but we must load it all.
-        const uint_t flags = HWLOC_TOPOLOGY_FLAG_INCLUDE_DISALLOWED;
+        uint_t flags = HWLOC_TOPOLOGY_FLAG_INCLUDE_DISALLOWED;
+        // hwloc turns binding operations into no-ops for topologies loaded
+        // from XML. Ours come from the server running on this node, so let
+        // the thread-local operations (e.g., memory binding) take effect.
+        if (m_topo_from_local_xml) {
+            flags |= HWLOC_TOPOLOGY_FLAG_IS_THISSYSTEM;
+        }
         rc = hwloc_topology_set_flags(m_topo, flags);
         if (qvi_unlikely(rc != 0)) {
             ers = "hwloc_topology_set_flags() failed";
@@ -355,12 +478,35 @@ qvi_hwloc::topology_load(void)
             break;
         }
 
+        // Device discovery only needs PCI devices and their OS devices.
+        if (lean) {
+            rc = hwloc_topology_set_type_filter(
+                m_topo, HWLOC_OBJ_BRIDGE, HWLOC_TYPE_FILTER_KEEP_NONE
+            );
+            if (qvi_unlikely(rc != 0)) {
+                ers = "hwloc_topology_set_type_filter() failed";
+                rc = QV_ERR_HWLOC;
+                break;
+            }
+            rc = hwloc_topology_set_type_filter(
+                m_topo, HWLOC_OBJ_MISC, HWLOC_TYPE_FILTER_KEEP_NONE
+            );
+            if (qvi_unlikely(rc != 0)) {
+                ers = "hwloc_topology_set_type_filter() failed";
+                rc = QV_ERR_HWLOC;
+                break;
+            }
+        }
+
         rc = hwloc_topology_load(m_topo);
         if (qvi_unlikely(rc != 0)) {
             ers = "hwloc_topology_load() failed";
             rc = QV_ERR_HWLOC;
             break;
         }
+        // Note that we do not restrict lean topologies to the allowed
+        // resources: that renumbers objects, and clients and the server
+        // exchange logical indices, so their topologies must agree.
 
         rc = m_discover_devices();
         if (qvi_unlikely(rc != QV_SUCCESS)) {
@@ -506,7 +652,12 @@ qvi_hwloc::obj_get_type(
             return HWLOC_OBJ_L5CACHE;
         case(QV_HW_OBJ_NUMANODE):
             return HWLOC_OBJ_NUMANODE;
+        case(QV_HW_OBJ_DIE):
+            return HWLOC_OBJ_DIE;
+        case(QV_HW_OBJ_GROUP):
+            return HWLOC_OBJ_GROUP;
         case(QV_HW_OBJ_GPU):
+        case(QV_HW_OBJ_NIC):
             return HWLOC_OBJ_OS_DEVICE;
         default:
             // This is likely an internal development error.
@@ -529,8 +680,11 @@ qvi_hwloc::obj_is_host_resource(
         case(QV_HW_OBJ_L4CACHE):
         case(QV_HW_OBJ_L5CACHE):
         case(QV_HW_OBJ_NUMANODE):
+        case(QV_HW_OBJ_DIE):
+        case(QV_HW_OBJ_GROUP):
             return true;
         case(QV_HW_OBJ_GPU):
+        case(QV_HW_OBJ_NIC):
         case(QV_HW_OBJ_LAST):
             return false;
         default:
@@ -539,6 +693,22 @@ qvi_hwloc::obj_is_host_resource(
     }
 }
 
+bool
+qvi_hwloc::obj_is_cache(
+    qv_hw_obj_type_t type
+) {
+    switch (type) {
+        case QV_HW_OBJ_L1CACHE:
+        case QV_HW_OBJ_L2CACHE:
+        case QV_HW_OBJ_L3CACHE:
+        case QV_HW_OBJ_L4CACHE:
+        case QV_HW_OBJ_L5CACHE:
+            return true;
+        default:
+            return false;
+    }
+}
+
 int
 qvi_hwloc::obj_type_depth(
     qv_hw_obj_type_t type,
@@ -547,6 +717,15 @@ qvi_hwloc::obj_type_depth(
     *depth = hwloc_get_type_depth(
         m_topo, qvi_hwloc::obj_get_type(type)
     );
+    // Nested groups live at several depths, so use the outermost one.
+    if (*depth == HWLOC_TYPE_DEPTH_MULTIPLE) {
+        const int tdepth = hwloc_topology_get_depth(m_topo);
+        for (int d = 0; d < tdepth; ++d) {
+            if (hwloc_get_depth_type(m_topo, d) != HWLOC_OBJ_GROUP) continue;
+            *depth = d;
+            break;
+        }
+    }
     return QV_SUCCESS;
 }
 
@@ -639,16 +818,8 @@ qvi_hwloc::m_set_general_device_info(
     const std::string &pci_bus_id,
     qvi_hwloc_device *device
 ) {
-    switch (obj->attr->osdev.type) {
-        // For our purposes a HWLOC_OBJ_OSDEV_COPROC
-        // is the same as a HWLOC_OBJ_OSDEV_GPU.
-        case HWLOC_OBJ_OSDEV_GPU:
-        case HWLOC_OBJ_OSDEV_COPROC:
-            device->type = QV_HW_OBJ_GPU;
-            break;
-        default:
-            return QV_SUCCESS;
-    }
+    device->type = osdev_hwloc2qv(obj->attr->osdev.type);
+    if (device->type == QV_HW_OBJ_LAST) return QV_SUCCESS;
     // Set vendor ID.
     device->vendor_id = pci_obj->attr->pcidev.vendor_id;
     // Save device name.
@@ -689,9 +860,13 @@ qvi_hwloc::m_set_of_device_info(
     hwloc_obj_t obj,
     qvi_hwloc_device *device
 ) {
-    // TODO(skg) Get cpuset, if available.
-    device->uuid = std::string(hwloc_obj_get_info_by_name(obj, "NodeGUID"));
-    return QV_SUCCESS;
+    cstr_t guid = hwloc_obj_get_info_by_name(obj, "NodeGUID");
+    if (guid) device->uuid = std::string(guid);
+    // There is no management library that reports a NIC's affinity, so use
+    // the cpuset of the closest non-I/O ancestor of its PCI device instead.
+    hwloc_obj_t ancestor = hwloc_get_non_io_ancestor_obj(m_topo, obj);
+    if (qvi_unlikely(!ancestor || !ancestor->cpuset)) return QV_SUCCESS;
+    return device->affinity.set(ancestor->cpuset);
 }
 
 /**
@@ -820,6 +995,8 @@ qvi_hwloc::m_discover_nic_devices(void)
             auto nicdev = std::make_shared<qvi_hwloc_device>();
             rc = qvi_copy(*dev.get(), nicdev.get());
             if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+            // NICs have no visible device IDs, so use discovery order.
+            nicdev->id = int(m_nics.size());
             m_nics.push_back(nicdev);
         }
     }
@@ -892,16 +1069,41 @@ qvi_hwloc::task_set_cpubind_from_cpuset(
     return QV_SUCCESS;
 }
 
+int
+qvi_hwloc::pthread_attr_set_cpubind(
+    pthread_attr_t *attr,
+    hwloc_const_cpuset_t cpuset
+) {
+    // Empty and infinite cpusets cannot be expressed as a CPU set.
+    const int last = hwloc_bitmap_last(cpuset);
+    if (qvi_unlikely(last < 0)) return QV_ERR_INVLD_ARG;
+
+    cpu_set_t *schedset = CPU_ALLOC(last + 1);
+    if (qvi_unlikely(!schedset)) return QV_ERR_OOR;
+    const size_t schedsetsize = CPU_ALLOC_SIZE(last + 1);
+
+    int rc = hwloc_cpuset_to_glibc_sched_affinity(
+        m_topo, cpuset, schedset, schedsetsize
+    );
+    if (qvi_likely(rc == 0)) {
+        rc = pthread_attr_setaffinity_np(attr, schedsetsize, schedset);
+    }
+    CPU_FREE(schedset);
+    if (qvi_unlikely(rc != 0)) return QV_ERR_NOT_SUPPORTED;
+    return QV_SUCCESS;
+}
+
 int
 qvi_hwloc::m_obj_get_by_type(
     qv_hw_obj_type_t type,
     int type_index,
     hwloc_obj_t *obj
 ) {
-    const hwloc_obj_type_t obj_type = qvi_hwloc::obj_get_type(type);
-    *obj = hwloc_get_obj_by_type(
-        m_topo, obj_type, (uint_t)type_index
-    );
+    int depth;
+    const int rc = obj_type_depth(type, &depth);
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+
+    *obj = hwloc_get_obj_by_depth(m_topo, depth, (uint_t)type_index);
     return (*obj != nullptr ? QV_SUCCESS : QV_ERR_HWLOC);
 }
 
@@ -1008,6 +1210,8 @@ qvi_hwloc::get_nobjs_in_cpuset(
     switch (target_obj) {
         case(QV_HW_OBJ_GPU) :
             return m_get_nosdevs_in_cpuset(m_gpus, cpuset, nobjs);
+        case(QV_HW_OBJ_NIC) :
+            return m_get_nosdevs_in_cpuset(m_nics, cpuset, nobjs);
         default:
             return m_get_nobjs_in_cpuset(target_obj, cpuset, nobjs);
     }
@@ -1030,7 +1234,10 @@ qvi_hwloc::get_obj_type_in_cpuset(
         num = hwloc_get_nbobjs_inside_cpuset_by_type(topo, cpuset, obj->type);
     }
 
-    *target_obj = obj_hwloc2qv(obj->type);
+    *target_obj = obj_hwloc2qv(obj);
+    if (qvi_unlikely(*target_obj == QV_HW_OBJ_LAST)) {
+        return QV_ERR_NOT_SUPPORTED;
+    }
     return QV_SUCCESS;
 }
 
@@ -1051,7 +1258,8 @@ qvi_hwloc::get_obj_in_cpuset_by_depth(
 const std::vector<qv_hw_obj_type_t> &
 qvi_hwloc::supported_devices(void) {
     static const std::vector<qv_hw_obj_type_t> supported_devices = {
-        QV_HW_OBJ_GPU
+        QV_HW_OBJ_GPU,
+        QV_HW_OBJ_NIC
     };
     return supported_devices;
 }
@@ -1065,6 +1273,9 @@ qvi_hwloc::devices_emit(
         case QV_HW_OBJ_GPU:
             devlist = &m_gpus;
             break;
+        case QV_HW_OBJ_NIC:
+            devlist = &m_nics;
+            break;
         default:
             return QV_ERR_NOT_SUPPORTED;
     }
@@ -1113,6 +1324,9 @@ qvi_hwloc::get_devices_in_cpuset(
         case QV_HW_OBJ_GPU:
             devlist = &m_gpus;
             break;
+        case QV_HW_OBJ_NIC:
+            devlist = &m_nics;
+            break;
         default:
             return QV_ERR_NOT_SUPPORTED;
     }
@@ -1142,7 +1356,7 @@ qvi_hwloc::get_device_id_in_cpuset(
             dev_id = devs.at(i)->pci_bus_id;
             break;
         case (QV_DEVICE_ID_ORDINAL):
-            dev_id = devs.at(i)->id;
+            dev_id = std::to_string(devs.at(i)->id);
             break;
         default:
             rc = QV_ERR_INVLD_ARG;
@@ -1200,6 +1414,28 @@ qvi_hwloc::m_split_cpuset_by_range(
     return rc;
 }
 
+uint_t
+qvi_hwloc::m_cut_cost(
+    hwloc_obj_t left,
+    hwloc_obj_t right
+) {
+    // Every normal ancestor below the root that holds both PUs is split.
+    const hwloc_obj_t common = hwloc_get_common_ancestor_obj(
+        m_topo, left, right
+    );
+    uint_t cost = common->depth;
+    // NUMA nodes are memory children, not ancestors, so check them directly.
+    hwloc_obj_t numa = nullptr;
+    while ((numa = hwloc_get_next_obj_by_type(
+                m_topo, HWLOC_OBJ_NUMANODE, numa))) {
+        if (hwloc_bitmap_isset(numa->cpuset, left->os_index) &&
+            hwloc_bitmap_isset(numa->cpuset, right->os_index)) {
+            cost++;
+        }
+    }
+    return cost;
+}
+
 int
 qvi_hwloc::get_cpuset_for_nobjs(
     hwloc_const_cpuset_t cpuset,
@@ -1230,6 +1466,132 @@ qvi_hwloc::get_cpuset_for_nobjs(
     return rc;
 }
 
+int
+qvi_hwloc::get_obj_cpusets_in_cpuset(
+    qv_hw_obj_type_t obj_type,
+    hwloc_const_cpuset_t cpuset,
+    qvi_hwloc_bitmaps &result
+) {
+    int depth;
+    const int rc = obj_type_depth(obj_type, &depth);
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+
+    result.clear();
+    hwloc_obj_t obj = nullptr;
+    while ((obj = hwloc_get_next_obj_by_depth(m_topo, depth, obj))) {
+        if (!hwloc_bitmap_isincluded(obj->cpuset, cpuset)) continue;
+        if (hwloc_bitmap_iszero(obj->cpuset)) continue;
+        result.emplace_back(obj->cpuset);
+    }
+    return QV_SUCCESS;
+}
+
+int
+qvi_hwloc::get_numa_domain_cpusets_in_cpuset(
+    hwloc_const_cpuset_t cpuset,
+    qvi_hwloc_bitmaps &result
+) {
+    qvi_hwloc_bitmaps nodes;
+    const int rc = get_obj_cpusets_in_cpuset(
+        QV_HW_OBJ_NUMANODE, cpuset, nodes
+    );
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+
+    result.clear();
+    for (const auto &node : nodes) {
+        bool tier = false;
+        for (const auto &domain : result) {
+            if (hwloc_bitmap_isequal(node.cdata(), domain.cdata())) {
+                tier = true;
+                break;
+            }
+        }
+        if (!tier) result.push_back(node);
+    }
+    return QV_SUCCESS;
+}
+
+int
+qvi_hwloc::get_core_cpusets_in_cpuset(
+    hwloc_const_cpuset_t cpuset,
+    qvi_hwloc_bitmaps &result
+) {
+    result.clear();
+    hwloc_obj_t core = nullptr;
+    while ((core = hwloc_get_next_obj_by_type(m_topo, HWLOC_OBJ_CORE, core))) {
+        if (!hwloc_bitmap_intersects(core->cpuset, cpuset)) continue;
+
+        qvi_hwloc_bitmap core_cpuset;
+        const int rc = hwloc_bitmap_and(
+            core_cpuset.data(), core->cpuset, cpuset
+        );
+        if (qvi_unlikely(rc != 0)) return QV_ERR_HWLOC;
+        result.push_back(core_cpuset);
+    }
+    return QV_SUCCESS;
+}
+
+int
+qvi_hwloc::get_cpuset_for_cache_capacity(
+    hwloc_const_cpuset_t cpuset,
+    uint64_t nbytes,
+    qvi_hwloc_bitmap &result
+) {
+    // Gather the cores in the cpuset, along with
+    // the data caches each one of them can use.
+    std::vector<hwloc_obj_t> cores;
+    std::vector<std::vector<hwloc_obj_t>> core_caches;
+    hwloc_obj_t core = nullptr;
+    while ((core = hwloc_get_next_obj_by_type(m_topo, HWLOC_OBJ_CORE, core))) {
+        if (!hwloc_bitmap_isincluded(core->cpuset, cpuset)) continue;
+        if (hwloc_bitmap_iszero(core->cpuset)) continue;
+
+        std::vector<hwloc_obj_t> caches;
+        for (hwloc_obj_t obj = core->parent; obj; obj = obj->parent) {
+            if (!hwloc_obj_type_is_dcache(obj->type)) continue;
+            caches.push_back(obj);
+        }
+        cores.push_back(core);
+        core_caches.push_back(caches);
+    }
+    // Greedily add the core contributing the most cache not yet covered,
+    // preferring lower logical indices on ties, until the working set fits.
+    hwloc_bitmap_zero(result.data());
+    std::set<hwloc_obj_t> covered;
+    std::vector<bool> chosen(cores.size(), false);
+    uint64_t capacity = 0;
+    do {
+        int besti = -1;
+        uint64_t best_gain = 0;
+        for (size_t i = 0; i < cores.size(); ++i) {
+            if (chosen[i]) continue;
+            uint64_t gain = 0;
+            for (const auto &cache : core_caches[i]) {
+                if (covered.count(cache)) continue;
+                gain += cache->attr->cache.size;
+            }
+            if (besti == -1 || gain > best_gain) {
+                besti = i;
+                best_gain = gain;
+            }
+        }
+        // No cores left or no more cache to gain.
+        if (besti == -1 || (best_gain == 0 && capacity < nbytes)) {
+            return QV_RES_UNAVAILABLE;
+        }
+        chosen[besti] = true;
+        capacity += best_gain;
+        covered.insert(core_caches[besti].begin(), core_caches[besti].end());
+
+        const int rc = hwloc_bitmap_or(
+            result.data(), result.cdata(), cores[besti]->cpuset
+        );
+        if (qvi_unlikely(rc != 0)) return QV_ERR_HWLOC;
+    } while (capacity < nbytes);
+
+    return QV_SUCCESS;
+}
+
 qvi_hwloc_bitmap
 qvi_hwloc::bitmap_disable_smt(
     const qvi_hwloc_bitmap &bitmap
@@ -1265,6 +1627,9 @@ qvi_hwloc::get_device_affinity(
         case(QV_HW_OBJ_GPU) :
             devlist = &m_gpus;
             break;
+        case(QV_HW_OBJ_NIC) :
+            devlist = &m_nics;
+            break;
         default:
             return QV_ERR_NOT_SUPPORTED;
     }
@@ -1277,6 +1642,317 @@ qvi_hwloc::get_device_affinity(
     return QV_ERR_NOT_FOUND;
 }
 
+std::vector<hwloc_obj_t>
+qvi_hwloc::m_get_numa_nodes_in_cpuset(
+    hwloc_const_cpuset_t cpuset
+) {
+    std::vector<hwloc_obj_t> nodes;
+    // NUMA nodes without CPUs carry the cpuset of their locality, so
+    // intersection captures both regular and CPU-less memory nodes.
+    hwloc_obj_t obj = nullptr;
+    while ((obj = hwloc_get_next_obj_by_type(m_topo, HWLOC_OBJ_NUMANODE, obj))) {
+        if (!hwloc_bitmap_intersects(obj->cpuset, cpuset)) continue;
+        nodes.push_back(obj);
+    }
+    return nodes;
+}
+
+int
+qvi_hwloc::m_numa_distances_from_matrix(
+    const std::vector<hwloc_obj_t> &nodes,
+    qv_hw_distance_kind_t kind,
+    qvi_hwloc_distances &result,
+    bool *found
+) {
+    *found = false;
+
+    unsigned long hkind = 0;
+    switch (kind) {
+        case QV_HW_DISTANCE_LATENCY:
+            hkind = HWLOC_DISTANCES_KIND_MEANS_LATENCY;
+            break;
+        case QV_HW_DISTANCE_BANDWIDTH:
+            hkind = HWLOC_DISTANCES_KIND_MEANS_BANDWIDTH;
+            break;
+        default:
+            return QV_ERR_INVLD_ARG;
+    }
+
+    unsigned nr = 1;
+    hwloc_distances_s *dist = nullptr;
+    const int rc = hwloc_distances_get_by_type(
+        m_topo, HWLOC_OBJ_NUMANODE, &nr, &dist, hkind, 0
+    );
+    if (qvi_unlikely(rc != 0)) return QV_ERR_HWLOC;
+    if (nr == 0) return QV_SUCCESS;
+
+    const uint_t nnodes = nodes.size();
+    for (uint_t i = 0; i < nnodes; ++i) {
+        for (uint_t j = 0; j < nnodes; ++j) {
+            hwloc_uint64_t ij = 0, ji = 0;
+            // Nodes missing from the matrix keep their unknown distance.
+            const int prc = hwloc_distances_obj_pair_values(
+                dist, nodes[i], nodes[j], &ij, &ji
+            );
+            if (prc != 0) continue;
+            result.values[i * nnodes + j] = ij;
+        }
+    }
+    hwloc_distances_release(m_topo, dist);
+    *found = true;
+    return QV_SUCCESS;
+}
+
+int
+qvi_hwloc::m_numa_distances_from_memattrs(
+    const std::vector<hwloc_obj_t> &nodes,
+    qv_hw_distance_kind_t kind,
+    qvi_hwloc_distances &result
+) {
+    hwloc_memattr_id_t attr;
+    switch (kind) {
+        case QV_HW_DISTANCE_LATENCY:
+            attr = HWLOC_MEMATTR_ID_LATENCY;
+            break;
+        case QV_HW_DISTANCE_BANDWIDTH:
+            attr = HWLOC_MEMATTR_ID_BANDWIDTH;
+            break;
+        default:
+            return QV_ERR_INVLD_ARG;
+    }
+
+    const uint_t nnodes = nodes.size();
+    for (uint_t j = 0; j < nnodes; ++j) {
+        // First query the number of initiators for this target node.
+        unsigned ninit = 0;
+        int rc = hwloc_memattr_get_initiators(
+            m_topo, attr, nodes[j], 0, &ninit, nullptr, nullptr
+        );
+        if (rc != 0 || ninit == 0) continue;
+
+        std::vector<hwloc_location> inits(ninit);
+        std::vector<hwloc_uint64_t> values(ninit);
+        rc = hwloc_memattr_get_initiators(
+            m_topo, attr, nodes[j], 0, &ninit, inits.data(), values.data()
+        );
+        if (qvi_unlikely(rc != 0)) return QV_ERR_HWLOC;
+
+        for (uint_t i = 0; i < nnodes; ++i) {
+            uint64_t best = 0;
+            for (unsigned k = 0; k < ninit; ++k) {
+                hwloc_const_cpuset_t icpuset = nullptr;
+                if (inits[k].type == HWLOC_LOCATION_TYPE_CPUSET) {
+                    icpuset = inits[k].location.cpuset;
+                }
+                else if (inits[k].type == HWLOC_LOCATION_TYPE_OBJECT) {
+                    icpuset = inits[k].location.object->cpuset;
+                }
+                if (!icpuset) continue;
+                if (!hwloc_bitmap_intersects(icpuset, nodes[i]->cpuset)) {
+                    continue;
+                }
+                // Keep the best value reachable from node i's processors.
+                const bool better = (best == 0) ||
+                    (attr == HWLOC_MEMATTR_ID_LATENCY ?
+                     values[k] < best : values[k] > best);
+                if (better) best = values[k];
+            }
+            result.values[i * nnodes + j] = best;
+        }
+    }
+    return QV_SUCCESS;
+}
+
+int
+qvi_hwloc::get_numa_distances(
+    hwloc_const_cpuset_t cpuset,
+    qv_hw_distance_kind_t kind,
+    qvi_hwloc_distances &result
+) {
+    const std::vector<hwloc_obj_t> nodes = m_get_numa_nodes_in_cpuset(cpuset);
+
+    result.nnodes = nodes.size();
+    result.values.assign(result.nnodes * result.nnodes, 0);
+
+    bool found = false;
+    const int rc = m_numa_distances_from_matrix(nodes, kind, result, &found);
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+    if (found) return QV_SUCCESS;
+    // No distance matrix, so fall back to memory attributes (e.g., HMAT).
+    return m_numa_distances_from_memattrs(nodes, kind, result);
+}
+
+int
+qvi_hwloc::get_numa_index_in_cpuset(
+    hwloc_const_cpuset_t cpuset,
+    hwloc_const_cpuset_t obj_cpuset,
+    int *index
+) {
+    const std::vector<hwloc_obj_t> nodes = m_get_numa_nodes_in_cpuset(cpuset);
+
+    const int nnodes = nodes.size();
+    for (int i = 0; i < nnodes; ++i) {
+        if (!hwloc_bitmap_intersects(nodes[i]->cpuset, obj_cpuset)) continue;
+        *index = i;
+        return QV_SUCCESS;
+    }
+    *index = -1;
+    return QV_ERR_NOT_FOUND;
+}
+
+int
+qvi_hwloc::get_obj_index_of_first_pu(
+    hwloc_const_cpuset_t cpuset,
+    hwloc_obj_type_t type
+) {
+    const int pu_id = hwloc_bitmap_first(cpuset);
+    if (pu_id < 0) return -1;
+    // NUMA nodes are not ancestors of PUs, so go by their cpusets.
+    if (type == HWLOC_OBJ_NUMANODE) {
+        hwloc_obj_t node = nullptr;
+        while ((node = hwloc_get_next_obj_by_type(m_topo, type, node))) {
+            if (hwloc_bitmap_isset(node->cpuset, pu_id)) {
+                return int(node->logical_index);
+            }
+        }
+        return -1;
+    }
+    const hwloc_obj_t pu = hwloc_get_pu_obj_by_os_index(m_topo, pu_id);
+    if (!pu) return -1;
+    const hwloc_obj_t obj = hwloc_get_ancestor_obj_by_type(m_topo, type, pu);
+    return obj ? int(obj->logical_index) : -1;
+}
+
+uint64_t
+qvi_hwloc::m_get_numa_node_memattr(
+    hwloc_obj_t node,
+    hwloc_memattr_id_t attr
+) {
+    hwloc_uint64_t value = 0;
+
+    hwloc_location local;
+    local.type = HWLOC_LOCATION_TYPE_CPUSET;
+    local.location.cpuset = node->cpuset;
+    int rc = hwloc_memattr_get_value(m_topo, attr, node, &local, 0, &value);
+    if (rc == 0) return value;
+    // Nothing for local CPUs, so settle for the best any initiator sees.
+    hwloc_location best;
+    rc = hwloc_memattr_get_best_initiator(m_topo, attr, node, 0, &best, &value);
+    if (rc == 0) return value;
+    return 0;
+}
+
+int
+qvi_hwloc::get_numa_nodes_in_cpuset(
+    hwloc_const_cpuset_t cpuset,
+    qvi_hwloc_numa_nodes &result
+) {
+    result.clear();
+    for (const auto &node : m_get_numa_nodes_in_cpuset(cpuset)) {
+        qvi_hwloc_numa_node info;
+        info.os_index = node->os_index;
+        if (node->subtype) info.subtype = node->subtype;
+        info.capacity = node->attr->numanode.local_memory;
+        info.bandwidth = m_get_numa_node_memattr(
+            node, HWLOC_MEMATTR_ID_BANDWIDTH
+        );
+        info.latency = m_get_numa_node_memattr(
+            node, HWLOC_MEMATTR_ID_LATENCY
+        );
+        const int rc = info.affinity.set(node->cpuset);
+        if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+
+        result.push_back(info);
+    }
+    return QV_SUCCESS;
+}
+
+int
+qvi_hwloc::get_cpukinds_in_cpuset(
+    hwloc_const_cpuset_t cpuset,
+    qvi_hwloc_cpukinds &result
+) {
+    result.clear();
+
+    const int nkinds = hwloc_cpukinds_get_nr(m_topo, 0);
+    if (qvi_unlikely(nkinds < 0)) return QV_ERR_HWLOC;
+    // hwloc reports kinds from the least to the most performant,
+    // so walk them backwards to rank the most performant first.
+    for (int i = nkinds - 1; i >= 0; --i) {
+        qvi_hwloc_cpukind kind;
+        unsigned ninfos = 0;
+        struct hwloc_info_s *infos = nullptr;
+        int rc = hwloc_cpukinds_get_info(
+            m_topo, i, kind.cpuset.data(), &kind.efficiency,
+            &ninfos, &infos, 0
+        );
+        if (qvi_unlikely(rc != 0)) return QV_ERR_HWLOC;
+
+        rc = hwloc_bitmap_and(
+            kind.cpuset.data(), kind.cpuset.cdata(), cpuset
+        );
+        if (qvi_unlikely(rc != 0)) return QV_ERR_HWLOC;
+        if (hwloc_bitmap_iszero(kind.cpuset.cdata())) continue;
+
+        for (unsigned j = 0; j < ninfos; ++j) {
+            if (strcmp(infos[j].name, "CoreType") != 0) continue;
+            kind.core_type = infos[j].value;
+            break;
+        }
+        result.push_back(kind);
+    }
+    // No kind information, so everything is of the same kind.
+    if (result.empty() && !hwloc_bitmap_iszero(cpuset)) {
+        qvi_hwloc_cpukind kind;
+        kind.efficiency = 0;
+        const int rc = kind.cpuset.set(cpuset);
+        if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+        result.push_back(kind);
+    }
+    return QV_SUCCESS;
+}
+
+int
+qvi_hwloc::bitmap_restrict_to_cpukind(
+    const qvi_hwloc_bitmap &bitmap,
+    bool performance,
+    qvi_hwloc_bitmap &result
+) {
+    qvi_hwloc_cpukinds kinds;
+    const int rc = get_cpukinds_in_cpuset(bitmap.cdata(), kinds);
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+    if (kinds.empty()) return QV_RES_UNAVAILABLE;
+
+    const qvi_hwloc_cpukind &kind = performance ? kinds.front() : kinds.back();
+    return result.set(kind.cpuset.cdata());
+}
+
+int
+qvi_hwloc::thread_get_membind(
+    qvi_hwloc_bitmap &nodeset,
+    hwloc_membind_policy_t &policy
+) {
+    const int rc = hwloc_get_membind(
+        m_topo, nodeset.data(), &policy,
+        HWLOC_MEMBIND_THREAD | HWLOC_MEMBIND_BYNODESET
+    );
+    if (qvi_unlikely(rc != 0)) return QV_ERR_NOT_SUPPORTED;
+    return QV_SUCCESS;
+}
+
+int
+qvi_hwloc::thread_set_membind(
+    hwloc_const_nodeset_t nodeset,
+    hwloc_membind_policy_t policy
+) {
+    const int rc = hwloc_set_membind(
+        m_topo, nodeset, policy,
+        HWLOC_MEMBIND_THREAD | HWLOC_MEMBIND_BYNODESET
+    );
+    if (qvi_unlikely(rc != 0)) return QV_ERR_NOT_SUPPORTED;
+    return QV_SUCCESS;
+}
+
 /*
  * vim: ft=cpp ts=4 sts=4 sw=4 expandtab
  */
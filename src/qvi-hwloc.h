@@ -22,6 +22,9 @@
 // Forward declarations.
 struct qvi_hwloc_bitmap;
 struct qvi_hwloc_device;
+struct qvi_hwloc_distances;
+struct qvi_hwloc_numa_node;
+struct qvi_hwloc_cpukind;
 
 /** Vector of bitmap objects. */
 using qvi_hwloc_bitmaps = std::vector<qvi_hwloc_bitmap>;
@@ -31,6 +34,10 @@ using qvi_hwloc_dev_id_set = std::unordered_set<std::string>;
 using qvi_hwloc_dev_list = std::vector<
     std::shared_ptr<qvi_hwloc_device>
 >;
+/** NUMA node list type. */
+using qvi_hwloc_numa_nodes = std::vector<qvi_hwloc_numa_node>;
+/** CPU kind list type. */
+using qvi_hwloc_cpukinds = std::vector<qvi_hwloc_cpukind>;
 
 struct qvi_hwloc {
 private:
@@ -42,6 +49,11 @@ private:
     hwloc_topology_t m_topo = nullptr;
     /** Path to exported hardware topology. */
     std::string m_topo_file;
+    /**
+     * Whether the topology was set from an XML file exported by the local
+     * server, in which case it describes the system we are running on.
+     */
+    bool m_topo_from_local_xml = false;
     /** Cached set of PCI IDs discovered during topology load. */
     qvi_hwloc_dev_id_set m_device_ids;
     /** Cached devices discovered during topology load. */
@@ -56,6 +68,11 @@ private:
         const std::string &path
     );
     /** */
+    int
+    m_topo_set_from_synthetic(
+        const std::string &description
+    );
+    /** */
     static int
     s_topo_fopen(
         const char *path,
@@ -158,6 +175,44 @@ private:
         uint_t extent,
         hwloc_bitmap_t result
     );
+    /**
+     * Returns the number of objects, NUMA nodes included, that a cut between
+     * the two provided neighboring PUs would split.
+     */
+    uint_t
+    m_cut_cost(
+        hwloc_obj_t left,
+        hwloc_obj_t right
+    );
+    /** Returns the NUMA nodes local to the provided cpuset. */
+    std::vector<hwloc_obj_t>
+    m_get_numa_nodes_in_cpuset(
+        hwloc_const_cpuset_t cpuset
+    );
+    /** Populates NUMA distances from a distance matrix, if available. */
+    int
+    m_numa_distances_from_matrix(
+        const std::vector<hwloc_obj_t> &nodes,
+        qv_hw_distance_kind_t kind,
+        qvi_hwloc_distances &result,
+        bool *found
+    );
+    /** Populates NUMA distances from memory attributes. */
+    int
+    m_numa_distances_from_memattrs(
+        const std::vector<hwloc_obj_t> &nodes,
+        qv_hw_distance_kind_t kind,
+        qvi_hwloc_distances &result
+    );
+    /**
+     * Returns the value of the given memory attribute for the provided NUMA
+     * node as seen from its local CPUs. Returns zero if unknown.
+     */
+    uint64_t
+    m_get_numa_node_memattr(
+        hwloc_obj_t node,
+        hwloc_memattr_id_t attr
+    );
 public:
     /** */
     static void
@@ -227,6 +282,20 @@ public:
         uint_t chunk_id,
         hwloc_cpuset_t result
     );
+    /**
+     * Splits the provided cpuset into npieces pieces of consecutive PUs.
+     * Balance comes first: piece sizes always differ by at most one PU, even
+     * when that means straddling a package. Among such splits, the one whose
+     * cuts split the fewest objects is chosen, so that pieces straddle as few
+     * package, NUMA, and cache boundaries as their sizes allow. NUMA nodes
+     * are accounted for even though they are not ancestors of PUs.
+     */
+    int
+    bitmap_split_hierarchical(
+        hwloc_const_cpuset_t bitmap,
+        uint_t npieces,
+        qvi_hwloc_bitmaps &result
+    );
     /** Constructor */
     qvi_hwloc(void) = default;
     /** Destructor */
@@ -237,18 +306,26 @@ public:
     /** Delete copy constructor. */
     qvi_hwloc(const qvi_hwloc &) = delete;
     /**
-     * Initialize hardware topology. If an XML path is provided, set
-     * the hardware topology based on the contents of the XML file.
+     * Initialize hardware topology. If a synthetic description is provided
+     * (e.g., "pack:8 numa:2 core:64 pu:2"), build the hardware topology from
+     * it. Otherwise, if an XML path is provided, set the hardware topology
+     * based on the contents of the XML file. Synthetic topologies do not
+     * describe this system, so binding operations are not supported on them.
      */
     int
     topology_init(
-        const std::string &xml_path = ""
+        const std::string &xml_path = "",
+        const std::string &synthetic = ""
     );
     /**
-     *
+     * Loads the initialized topology. A lean topology drops the bridges and
+     * Misc objects that device discovery does not need. Its normal objects,
+     * and so their logical indices, are the same as in a full topology.
      */
     int
-    topology_load(void);
+    topology_load(
+        bool lean = false
+    );
     /**
      *
      */
@@ -294,6 +371,13 @@ public:
     obj_is_host_resource(
         qv_hw_obj_type_t type
     );
+    /**
+     * Returns whether the provided type is a cache.
+     */
+    static bool
+    obj_is_cache(
+        qv_hw_obj_type_t type
+    );
     /**
      *
      */
@@ -359,6 +443,15 @@ public:
         pid_t task_id,
         hwloc_const_cpuset_t cpuset
     );
+    /**
+     * Sets the CPU affinity of threads created with the provided attributes,
+     * so that they start on the cpuset.
+     */
+    int
+    pthread_attr_set_cpubind(
+        pthread_attr_t *attr,
+        hwloc_const_cpuset_t cpuset
+    );
     /** */
     int
     task_intersects_obj_by_type_id(
@@ -421,6 +514,48 @@ public:
         uint_t nobjs,
         qvi_hwloc_bitmap &result
     );
+    /**
+     * Returns the cpusets of the objects of the provided type contained in
+     * the cpuset, in logical order. Objects are counted as get_nobjs_in_cpuset()
+     * counts them.
+     */
+    int
+    get_obj_cpusets_in_cpuset(
+        qv_hw_obj_type_t obj_type,
+        hwloc_const_cpuset_t cpuset,
+        qvi_hwloc_bitmaps &result
+    );
+    /**
+     * Returns the cpusets of the NUMA domains contained in the cpuset, in
+     * logical order. NUMA nodes local to the same CPUs, like a package's DRAM
+     * and HBM nodes, are memory tiers of one domain.
+     */
+    int
+    get_numa_domain_cpusets_in_cpuset(
+        hwloc_const_cpuset_t cpuset,
+        qvi_hwloc_bitmaps &result
+    );
+    /**
+     * Returns, in logical order, the PUs of each core that intersects the
+     * provided cpuset. Unlike get_obj_cpusets_in_cpuset(), partially
+     * included cores (e.g., with SMT disabled) are kept.
+     */
+    int
+    get_core_cpusets_in_cpuset(
+        hwloc_const_cpuset_t cpuset,
+        qvi_hwloc_bitmaps &result
+    );
+    /**
+     * Returns the cpuset of a set of cores in the provided cpuset whose
+     * private and shared data caches together hold at least nbytes. Cores are
+     * added greedily, so the set is small but not necessarily minimal.
+     */
+    int
+    get_cpuset_for_cache_capacity(
+        hwloc_const_cpuset_t cpuset,
+        uint64_t nbytes,
+        qvi_hwloc_bitmap &result
+    );
     /**
      * Takes a bitmap and returns a new one with SMT disabled.
      */
@@ -428,6 +563,76 @@ public:
     bitmap_disable_smt(
         const qvi_hwloc_bitmap &bitmap
     );
+    /**
+     * Returns the distances between the NUMA nodes local to the provided
+     * cpuset. Distance matrices are preferred over memory attributes.
+     */
+    int
+    get_numa_distances(
+        hwloc_const_cpuset_t cpuset,
+        qv_hw_distance_kind_t kind,
+        qvi_hwloc_distances &result
+    );
+    /**
+     * Returns the index of the first NUMA node local to cpuset that is also
+     * local to obj_cpuset. Indices match those used by get_numa_distances().
+     */
+    int
+    get_numa_index_in_cpuset(
+        hwloc_const_cpuset_t cpuset,
+        hwloc_const_cpuset_t obj_cpuset,
+        int *index
+    );
+    /**
+     * Returns the logical index of the object of the provided type that
+     * contains the first PU of cpuset, or -1 if there is none.
+     */
+    int
+    get_obj_index_of_first_pu(
+        hwloc_const_cpuset_t cpuset,
+        hwloc_obj_type_t type
+    );
+    /**
+     * Returns the NUMA nodes local to the provided cpuset and their memory
+     * attributes. Nodes are in the order used by get_numa_distances().
+     */
+    int
+    get_numa_nodes_in_cpuset(
+        hwloc_const_cpuset_t cpuset,
+        qvi_hwloc_numa_nodes &result
+    );
+    /**
+     * Returns the CPU kinds present in the provided cpuset, ordered from the
+     * most to the least performant. Topologies without kind information
+     * report a single kind spanning the cpuset.
+     */
+    int
+    get_cpukinds_in_cpuset(
+        hwloc_const_cpuset_t cpuset,
+        qvi_hwloc_cpukinds &result
+    );
+    /**
+     * Takes a bitmap and returns a new one restricted to its most performant
+     * or most energy-efficient CPU kind.
+     */
+    int
+    bitmap_restrict_to_cpukind(
+        const qvi_hwloc_bitmap &bitmap,
+        bool performance,
+        qvi_hwloc_bitmap &result
+    );
+    /** Returns the calling thread's memory binding. */
+    int
+    thread_get_membind(
+        qvi_hwloc_bitmap &nodeset,
+        hwloc_membind_policy_t &policy
+    );
+    /** Sets the calling thread's memory binding. */
+    int
+    thread_set_membind(
+        hwloc_const_nodeset_t nodeset,
+        hwloc_membind_policy_t policy
+    );
 };
 
 /**
@@ -567,6 +772,59 @@ struct qvi_hwloc_device {
     std::string uuid;
 };
 
+/**
+ * NUMA distance matrix. The distance from node i
+ * to node j is stored at values[i * nnodes + j].
+ */
+struct qvi_hwloc_distances {
+    /** Number of NUMA nodes described by the matrix. */
+    uint_t nnodes = 0;
+    /** Row-major distance values. Zero denotes an unknown distance. */
+    std::vector<uint64_t> values;
+
+    template <class Archive>
+    void
+    serialize(
+        Archive &archive
+    ) {
+        archive(nnodes, values);
+    }
+};
+
+/**
+ * A NUMA node and its memory attributes. Performance values are those seen
+ * from the node's local CPUs. Values of zero are unknown.
+ */
+struct qvi_hwloc_numa_node {
+    /** The node's OS index. */
+    uint_t os_index = 0;
+    /** Memory subtype (e.g., HBM). Empty for regular memory. */
+    std::string subtype;
+    /** Capacity in bytes. */
+    uint64_t capacity = 0;
+    /** Bandwidth in MiB/s. */
+    uint64_t bandwidth = 0;
+    /** Latency in nanoseconds. */
+    uint64_t latency = 0;
+    /** The node's locality. */
+    qvi_hwloc_bitmap affinity;
+};
+
+/**
+ * A kind of CPU core (e.g., performance or efficiency cores on hybrid CPUs).
+ */
+struct qvi_hwloc_cpukind {
+    /**
+     * hwloc efficiency ranking: higher values denote more performant kinds.
+     * Set to -1 when unknown.
+     */
+    int efficiency = -1;
+    /** Core type reported by the OS (e.g., IntelAtom). May be empty. */
+    std::string core_type;
+    /** The PUs of this kind. */
+    qvi_hwloc_bitmap cpuset;
+};
+
 #endif
 
 /*
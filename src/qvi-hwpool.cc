@@ -36,10 +36,14 @@ qvi_hwpool_res::affinity(void) const
 qvi_hwpool_dev::qvi_hwpool_dev(
     const qvi_hwloc_device &dev
 ) : m_type(dev.type)
-  , m_affinity(dev.affinity)
   , m_id(dev.id)
   , m_pci_bus_id(dev.pci_bus_id)
-  , m_uuid(dev.uuid) { }
+  , m_uuid(dev.uuid)
+{
+    // The affinity lives in our base class, so set it here.
+    const int rc = m_affinity.set(dev.affinity.cdata());
+    if (qvi_unlikely(rc != QV_SUCCESS)) throw qvi_runtime_error(rc);
+}
 
 qvi_hwpool_dev::qvi_hwpool_dev(
     const std::shared_ptr<qvi_hwloc_device> &shdev
@@ -86,6 +90,71 @@ qvi_hwpool_dev::id(
     return rc;
 }
 
+qvi_hwpool_mem::qvi_hwpool_mem(
+    const qvi_hwloc_numa_node &node
+) : m_os_index(node.os_index)
+  , m_subtype(node.subtype)
+  , m_capacity(node.capacity)
+  , m_bandwidth(node.bandwidth)
+  , m_latency(node.latency)
+{
+    const int rc = m_affinity.set(node.affinity.cdata());
+    if (qvi_unlikely(rc != QV_SUCCESS)) throw qvi_runtime_error(rc);
+}
+
+uint_t
+qvi_hwpool_mem::os_index(void) const
+{
+    return m_os_index;
+}
+
+const std::string &
+qvi_hwpool_mem::subtype(void) const
+{
+    return m_subtype;
+}
+
+int
+qvi_hwpool_mem::attr(
+    qv_numa_attr_t attr,
+    uint64_t *value
+) const {
+    switch (attr) {
+        case QV_NUMA_ATTR_CAPACITY:
+            *value = m_capacity;
+            return QV_SUCCESS;
+        case QV_NUMA_ATTR_BANDWIDTH:
+            *value = m_bandwidth;
+            return QV_SUCCESS;
+        case QV_NUMA_ATTR_LATENCY:
+            *value = m_latency;
+            return QV_SUCCESS;
+        default:
+            return QV_ERR_INVLD_ARG;
+    }
+}
+
+qvi_hwpool_cpukind::qvi_hwpool_cpukind(
+    const qvi_hwloc_cpukind &kind
+) : m_efficiency(kind.efficiency)
+  , m_core_type(kind.core_type)
+{
+    const int rc = m_affinity.set(kind.cpuset.cdata());
+    if (qvi_unlikely(rc != QV_SUCCESS)) throw qvi_runtime_error(rc);
+}
+
+int
+qvi_hwpool_cpukind::efficiency(void) const
+{
+    return m_efficiency;
+}
+
+const std::string &
+qvi_hwpool_cpukind::core_type(void) const
+{
+    return m_core_type;
+}
+
 int
 qvi_hwpool::m_add_devices_with_affinity(
     qvi_hwloc &hwloc
@@ -106,12 +175,52 @@ qvi_hwpool::m_add_devices_with_affinity(
     return rc;
 }
 
+int
+qvi_hwpool::m_add_mems_with_affinity(
+    qvi_hwloc &hwloc
+) {
+    qvi_hwloc_numa_nodes nodes;
+    const int rc = hwloc.get_numa_nodes_in_cpuset(
+        m_cpu.affinity().cdata(), nodes
+    );
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+
+    m_mems.clear();
+    for (const auto &node : nodes) {
+        m_mems.emplace_back(node);
+    }
+    return QV_SUCCESS;
+}
+
+int
+qvi_hwpool::m_add_cpukinds(
+    qvi_hwloc &hwloc
+) {
+    qvi_hwloc_cpukinds kinds;
+    const int rc = hwloc.get_cpukinds_in_cpuset(
+        m_cpu.affinity().cdata(), kinds
+    );
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+
+    m_cpukinds.clear();
+    for (const auto &kind : kinds) {
+        m_cpukinds.emplace_back(kind);
+    }
+    return QV_SUCCESS;
+}
+
 int
 qvi_hwpool::initialize(
     qvi_hwloc &hwloc,
     const qvi_hwloc_bitmap &cpuset
 ) {
-    const int rc = m_cpu.affinity().set(cpuset.cdata());
+    int rc = m_cpu.affinity().set(cpuset.cdata());
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+    // Add the CPU kinds found in the hardware pool.
+    rc = m_add_cpukinds(hwloc);
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+    // Add NUMA nodes local to the hardware pool.
+    rc = m_add_mems_with_affinity(hwloc);
     if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
     // Add devices with affinity to the hardware pool.
     return m_add_devices_with_affinity(hwloc);
@@ -129,6 +238,80 @@ qvi_hwpool::devices(void) const
     return m_devs;
 }
 
+const qvi_hwpool_mems_t &
+qvi_hwpool::mems(void) const
+{
+    return m_mems;
+}
+
+const qvi_hwpool_cpukinds_t &
+qvi_hwpool::cpukinds(void) const
+{
+    return m_cpukinds;
+}
+
+int
+qvi_hwpool::mem_best(
+    qv_numa_attr_t attr,
+    int *index
+) const {
+    *index = -1;
+
+    uint64_t best = 0;
+    const int nmems = m_mems.size();
+    for (int i = 0; i < nmems; ++i) {
+        uint64_t value = 0;
+        const int rc = m_mems[i].attr(attr, &value);
+        if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+        // Skip unknown values.
+        if (value == 0) continue;
+
+        const bool better = (attr == QV_NUMA_ATTR_LATENCY) ?
+            value < best : value > best;
+        if (*index == -1 || better) {
+            best = value;
+            *index = i;
+        }
+    }
+    if (*index == -1) return QV_ERR_NOT_FOUND;
+    return QV_SUCCESS;
+}
+
+int
+qvi_hwpool::mem_nodeset(
+    qvi_hwloc_bitmap &result
+) const {
+    hwloc_bitmap_zero(result.data());
+    for (const auto &mem : m_mems) {
+        const int rc = hwloc_bitmap_set(result.data(), mem.os_index());
+        if (qvi_unlikely(rc != 0)) return QV_ERR_HWLOC;
+    }
+    if (qvi_unlikely(hwloc_bitmap_iszero(result.cdata()))) {
+        return QV_ERR_NOT_FOUND;
+    }
+    return QV_SUCCESS;
+}
+
+int
+qvi_hwpool::mem_tier_nodeset(
+    qv_numa_attr_t attr,
+    qvi_hwloc_bitmap &result
+) const {
+    int besti = -1;
+    int rc = mem_best(attr, &besti);
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+
+    const std::string &tier = m_mems[besti].subtype();
+
+    hwloc_bitmap_zero(result.data());
+    for (const auto &mem : m_mems) {
+        if (mem.subtype() != tier) continue;
+        rc = hwloc_bitmap_set(result.data(), mem.os_index());
+        if (qvi_unlikely(rc != 0)) return QV_ERR_HWLOC;
+    }
+    return QV_SUCCESS;
+}
+
 int
 qvi_hwpool::nobjects(
     qvi_hwloc &hwloc,
@@ -69,8 +69,6 @@ struct qvi_hwpool_dev : qvi_hwpool_res {
 private:
     /** Device type. */
     qv_hw_obj_type_t m_type = QV_HW_OBJ_LAST;
-    /** The bitmap encoding CPU affinity. */
-    qvi_hwloc_bitmap m_affinity;
     /** Device ID (ordinal). */
     int m_id = qvi_hwloc_device::INVALID_ID;
     /** The PCI bus ID. */
@@ -117,6 +115,98 @@ public:
     }
 };
 
+/**
+ * Defines a hardware pool memory resource: a NUMA node and its attributes.
+ * The resource's affinity is the node's locality.
+ */
+struct qvi_hwpool_mem : qvi_hwpool_res {
+    friend class cereal::access;
+private:
+    /** The node's OS index. */
+    uint_t m_os_index = 0;
+    /** Memory subtype (e.g., HBM). Empty for regular memory. */
+    std::string m_subtype;
+    /** Capacity in bytes. */
+    uint64_t m_capacity = 0;
+    /** Bandwidth in MiB/s. */
+    uint64_t m_bandwidth = 0;
+    /** Latency in nanoseconds. */
+    uint64_t m_latency = 0;
+public:
+    /** Default constructor. */
+    qvi_hwpool_mem(void) = default;
+    /** Constructor using qvi_hwloc_numa_node. */
+    explicit qvi_hwpool_mem(
+        const qvi_hwloc_numa_node &node
+    );
+    /** Returns the node's OS index. */
+    uint_t
+    os_index(void) const;
+    /** Returns the node's memory subtype. */
+    const std::string &
+    subtype(void) const;
+    /** Returns the requested attribute. Zero denotes an unknown value. */
+    int
+    attr(
+        qv_numa_attr_t attr,
+        uint64_t *value
+    ) const;
+
+    template <class Archive>
+    void
+    serialize(
+        Archive &archive
+    ) {
+        archive(
+            m_hints, m_affinity, m_os_index,
+            m_subtype, m_capacity, m_bandwidth, m_latency
+        );
+    }
+};
+
+/** Vector of hardware pool memory resources. */
+using qvi_hwpool_mems_t = std::vector<qvi_hwpool_mem>;
+
+/**
+ * Defines a hardware pool CPU kind. The resource's affinity is the
+ * set of PUs of this kind that are in the hardware pool.
+ */
+struct qvi_hwpool_cpukind : qvi_hwpool_res {
+    friend class cereal::access;
+private:
+    /** hwloc efficiency ranking. Higher is more performant; -1 if unknown. */
+    int m_efficiency = -1;
+    /** Core type reported by the OS. May be empty. */
+    std::string m_core_type;
+public:
+    /** Default constructor. */
+    qvi_hwpool_cpukind(void) = default;
+    /** Constructor using qvi_hwloc_cpukind. */
+    explicit qvi_hwpool_cpukind(
+        const qvi_hwloc_cpukind &kind
+    );
+    /** Returns the kind's efficiency ranking. */
+    int
+    efficiency(void) const;
+    /** Returns the kind's core type. */
+    const std::string &
+    core_type(void) const;
+
+    template <class Archive>
+    void
+    serialize(
+        Archive &archive
+    ) {
+        archive(m_hints, m_affinity, m_efficiency, m_core_type);
+    }
+};
+
+/**
+ * Vector of hardware pool CPU kinds, ordered from the most to the least
+ * performant.
+ */
+using qvi_hwpool_cpukinds_t = std::vector<qvi_hwpool_cpukind>;
+
 /**
  * Maintains a mapping between device types and devices of those types.
  */
@@ -131,6 +221,10 @@ private:
     qvi_hwpool_cpu m_cpu;
     /** The hardware pool's devices. */
     qvi_hwpool_devs_t m_devs;
+    /** The hardware pool's NUMA nodes, ordered by logical index. */
+    qvi_hwpool_mems_t m_mems;
+    /** The hardware pool's CPU kinds. */
+    qvi_hwpool_cpukinds_t m_cpukinds;
     /**
      * Adds all devices with affinity to the
      * provided, initialized hardware resource pool.
@@ -139,6 +233,22 @@ private:
     m_add_devices_with_affinity(
         qvi_hwloc &hwloc
     );
+    /**
+     * Adds all NUMA nodes local to the
+     * provided, initialized hardware resource pool.
+     */
+    int
+    m_add_mems_with_affinity(
+        qvi_hwloc &hwloc
+    );
+    /**
+     * Adds the CPU kinds present in the
+     * provided, initialized hardware resource pool.
+     */
+    int
+    m_add_cpukinds(
+        qvi_hwloc &hwloc
+    );
 public:
     /**
      * Initializes a hardware pool from the given
@@ -159,6 +269,42 @@ public:
      */
     const qvi_hwpool_devs_t &
     devices(void) const;
+    /**
+     * Returns a const reference to the hardware pool's NUMA nodes.
+     */
+    const qvi_hwpool_mems_t &
+    mems(void) const;
+    /**
+     * Returns a const reference to the hardware pool's CPU kinds.
+     */
+    const qvi_hwpool_cpukinds_t &
+    cpukinds(void) const;
+    /**
+     * Returns the index of the NUMA node with the best value of the
+     * provided attribute: the largest capacity or bandwidth, or the lowest
+     * latency. Ties go to the lowest index.
+     */
+    int
+    mem_best(
+        qv_numa_attr_t attr,
+        int *index
+    ) const;
+    /**
+     * Returns the nodeset of the hardware pool's NUMA nodes.
+     */
+    int
+    mem_nodeset(
+        qvi_hwloc_bitmap &result
+    ) const;
+    /**
+     * Returns the nodeset of the memory tier that is best according to the
+     * provided attribute: the NUMA nodes sharing the best node's subtype.
+     */
+    int
+    mem_tier_nodeset(
+        qv_numa_attr_t attr,
+        qvi_hwloc_bitmap &result
+    ) const;
     /**
      * Returns the number of objects in the hardware pool.
      */
@@ -186,7 +332,7 @@ public:
     serialize(
         Archive &archive
     ) {
-        archive(m_cpu, m_devs);
+        archive(m_cpu, m_devs, m_mems, m_cpukinds);
     }
 };
 
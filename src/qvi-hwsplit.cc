@@ -145,11 +145,8 @@ qvi_hwsplit::qvi_hwsplit(
     rc = m_cpu_affinity.set(task_affinity.cdata());
     if (qvi_unlikely(rc != QV_SUCCESS)) throw qvi_runtime_error(rc);
 
-    // To save memory we don't eagerly resize our vectors to group_size
-    // since most processes will not use the storage. For example, in the
-    // collective case the root ID process will be the only one needing
-    // group_size elements in our vectors. We'll let the call paths enforce
-    // appropriate vector sizing.
+    // We don't eagerly resize our vectors to group_size here.
+    // We'll let the call paths enforce appropriate vector sizing.
 }
 
 void
@@ -171,20 +168,84 @@ int
 qvi_hwsplit::m_split_cpuset(
     qvi_hwloc_bitmaps &result
 ) const {
-    // Holds the host's split cpusets.
-    result.resize(m_split_size);
     // Notice that we do not go through the RMI for this because this is just an
     // local, temporary splitting that is ultimately fed to another splitting
     // algorithm.
     int rc = QV_SUCCESS;
-    for (uint_t chunkid = 0; chunkid < m_split_size; ++chunkid) {
-        rc = m_rmi.hwloc().bitmap_split_by_chunk_id(
-            m_cpuset().cdata(), m_split_size,
-            chunkid, result[chunkid].data()
+    // When splitting at NUMA nodes, each piece is a NUMA domain, which
+    // carries all the memory tiers local to its CPUs.
+    if (m_split_at_type == QV_HW_OBJ_NUMANODE) {
+        rc = m_rmi.hwloc().get_numa_domain_cpusets_in_cpuset(
+            m_cpuset().cdata(), result
         );
-        if (qvi_unlikely(rc != QV_SUCCESS)) break;
+        if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+        if (qvi_likely(result.size() == m_split_size)) return QV_SUCCESS;
     }
-    return rc;
+    // When splitting at a cache, die, or group, each piece is the set of cores
+    // sharing one such object. Evenly sized chunks may otherwise straddle
+    // object boundaries when objects hold differing numbers of cores.
+    if (qvi_hwloc::obj_is_cache(m_split_at_type) ||
+        m_split_at_type == QV_HW_OBJ_DIE ||
+        m_split_at_type == QV_HW_OBJ_GROUP) {
+        rc = m_rmi.hwloc().get_obj_cpusets_in_cpuset(
+            m_split_at_type, m_cpuset().cdata(), result
+        );
+        if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+        if (qvi_likely(result.size() == m_split_size)) return QV_SUCCESS;
+    }
+    // Otherwise, split into balanced pieces that straddle as few package,
+    // NUMA, and cache boundaries as possible.
+    return m_rmi.hwloc().bitmap_split_hierarchical(
+        m_cpuset().cdata(), m_split_size, result
+    );
+}
+
+int
+qvi_hwsplit::m_cpukind_cpusets(
+    bool balanced,
+    qvi_hwloc_bitmaps &result
+) const {
+    // Gather the cores of each kind, most performant kinds first.
+    std::vector<qvi_hwloc_bitmaps> kind_cores;
+    uint_t ncores = 0;
+    for (const auto &kind : m_hwpool.cpukinds()) {
+        qvi_hwloc_bitmaps cores;
+        const int rc = m_rmi.hwloc().get_core_cpusets_in_cpuset(
+            kind.affinity().cdata(), cores
+        );
+        if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+        ncores += cores.size();
+        kind_cores.push_back(cores);
+    }
+    if (ncores < m_split_size) return QV_ERR_SPLIT;
+
+    result.clear();
+    result.resize(m_split_size);
+    uint_t coreid = 0;
+    for (const auto &cores : kind_cores) {
+        for (const auto &core : cores) {
+            uint_t pieceid = 0;
+            // Deal cores round-robin, continuing where the last kind
+            // stopped so that piece sizes differ by at most one core.
+            if (balanced) {
+                pieceid = coreid % m_split_size;
+            }
+            // Contiguous chunks, with the leftovers going to the first pieces.
+            else {
+                const uint_t chunk = ncores / m_split_size;
+                const uint_t extra = ncores % m_split_size;
+                const uint_t split = extra * (chunk + 1);
+                pieceid = (coreid < split) ? coreid / (chunk + 1)
+                                           : extra + (coreid - split) / chunk;
+            }
+            const int rc = hwloc_bitmap_or(
+                result[pieceid].data(), result[pieceid].cdata(), core.cdata()
+            );
+            if (qvi_unlikely(rc != 0)) return QV_ERR_HWLOC;
+            coreid++;
+        }
+    }
+    return QV_SUCCESS;
 }
 
 int
@@ -319,8 +380,9 @@ qvi_hwsplit::split_devices_user_defined(void)
  * Affinity preserving device splitting.
  */
 int
-qvi_hwsplit::split_devices_affinity_preserving(void)
-{
+qvi_hwsplit::split_devices_affinity_preserving(
+    const qvi_hwloc_bitmaps &affinities
+) {
     // Release devices from the hardware pools because
     // they will be redistributed in the next step.
     int rc = m_release_devices();
@@ -345,15 +407,15 @@ qvi_hwsplit::split_devices_affinity_preserving(void)
         qvi_map_t map;
         const auto policy = affinity_preserving_policy();
         rc = qvi_map_affinity_preserving(
-            map, policy, devaffs, m_cpu_affinities
+            map, policy, devaffs, affinities
         );
         if (rc != QV_SUCCESS) return rc;
         //qvi_map_debug_dump(map);
         // Now that we have the mapping, assign
         // devices to the associated hardware pools.
-        for (const auto &mi : map) {
-            const uint_t devid = mi.first;
-            const uint_t pooli = mi.second;
+        for (uint_t devid = 0; devid < map.extent(); ++devid) {
+            if (!qvi_map_fid_mapped(map, devid)) continue;
+            const uint_t pooli = map.at(devid);
             rc = m_hwpools[pooli].add_device(*devs[devid]);
             if (rc != QV_SUCCESS) break;
         }
@@ -362,6 +424,46 @@ qvi_hwsplit::split_devices_affinity_preserving(void)
     return rc;
 }
 
+/**
+ * Returns the devices of the provided type, ordered so that consecutive devices
+ * come from different NUMA domains of the provided cpuset whenever possible.
+ */
+static int
+interleave_devices_by_numa(
+    qvi_hwloc &hwloc,
+    const qvi_hwloc_bitmap &cpuset,
+    std::vector<const qvi_hwpool_dev *> &devs
+) {
+    qvi_hwloc_bitmaps domains;
+    const int rc = hwloc.get_numa_domain_cpusets_in_cpuset(
+        cpuset.cdata(), domains
+    );
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+    // Bucket devices by the first domain they are local to. Devices local to
+    // none of them share a final bucket.
+    std::vector<std::vector<const qvi_hwpool_dev *>> buckets(domains.size() + 1);
+    for (const auto &dev : devs) {
+        uint_t domi = 0;
+        for (; domi < domains.size(); ++domi) {
+            if (hwloc_bitmap_intersects(
+                    dev->affinity().cdata(), domains[domi].cdata())) break;
+        }
+        buckets[domi].push_back(dev);
+    }
+    // Take one device from each domain in turn.
+    devs.clear();
+    for (uint_t round = 0; ; ++round) {
+        bool found = false;
+        for (const auto &bucket : buckets) {
+            if (round >= bucket.size()) continue;
+            devs.push_back(bucket[round]);
+            found = true;
+        }
+        if (!found) break;
+    }
+    return QV_SUCCESS;
+}
+
 static int
 apply_cpuset_mapping(
     qvi_hwloc &hwloc,
@@ -379,12 +481,66 @@ apply_cpuset_mapping(
         );
         if (rc != QV_SUCCESS) break;
     }
+    if (rc == QV_SUCCESS) {
+        rc = qvi_map_flatten_to_colors(map, colors);
+    }
     if (rc != QV_SUCCESS) {
         // Invalidate colors
         colors.clear();
     }
-    else {
-        colors = qvi_map_flatten_to_colors(map);
+    return rc;
+}
+
+/**
+ * Assigns each of the parent's devices to exactly one piece. Tasks then receive
+ * the devices of the piece they were mapped to.
+ */
+int
+qvi_hwsplit::split_devices_by_piece(
+    const qvi_map_t &map,
+    const qvi_hwloc_bitmaps &cpusets,
+    bool spread
+) {
+    // Release devices from the hardware pools because
+    // they will be redistributed in the next step.
+    int rc = m_release_devices();
+    if (rc != QV_SUCCESS) return rc;
+
+    const uint_t npieces = cpusets.size();
+    if (npieces == 0) return rc;
+    auto dinfos = m_hwpool.devices();
+    for (const auto devt : qvi_hwloc::supported_devices()) {
+        std::vector<const qvi_hwpool_dev *> devs;
+        for (const auto &dinfo : dinfos) {
+            // Not the type we are currently dealing with.
+            if (devt != dinfo.first) continue;
+            devs.push_back(dinfo.second.get());
+        }
+        // Spread places devices from alternating NUMA domains in turn, so no
+        // domain's devices are favored when pieces fill up.
+        if (spread) {
+            rc = interleave_devices_by_numa(m_rmi.hwloc(), m_cpuset(), devs);
+            if (rc != QV_SUCCESS) return rc;
+        }
+        qvi_hwloc_bitmaps devaffs;
+        for (const auto &dev : devs) {
+            devaffs.push_back(dev->affinity());
+        }
+        qvi_map_t devmap;
+        rc = qvi_map_devices(devmap, devaffs, cpusets, spread);
+        if (rc != QV_SUCCESS) return rc;
+        // The devices given to each piece.
+        std::vector<std::vector<const qvi_hwpool_dev *>> piece_devs(npieces);
+        for (uint_t devi = 0; devi < devs.size(); ++devi) {
+            piece_devs[devmap.at(devi)].push_back(devs[devi]);
+        }
+        // Give each task the devices of its piece.
+        for (uint_t tid = 0; tid < m_group_size; ++tid) {
+            for (const auto &dev : piece_devs.at(map.at(tid))) {
+                rc = m_hwpools[tid].add_device(*dev);
+                if (rc != QV_SUCCESS) return rc;
+            }
+        }
     }
     return rc;
 }
@@ -415,8 +571,9 @@ qvi_hwsplit::split_user_defined(void)
 }
 
 int
-qvi_hwsplit::split_affinity_preserving_pass1(void)
-{
+qvi_hwsplit::split_affinity_preserving_pass1(
+    bool optimal
+) {
     // cpusets used for first mapping pass.
     qvi_hwloc_bitmaps cpusets;
     // Get the primary cpusets used for the first pass of mapping.
@@ -426,10 +583,29 @@ qvi_hwsplit::split_affinity_preserving_pass1(void)
     qvi_map_t map;
     // Map tasks based on their affinity to resources encoded by the cpusets.
     const auto policy = affinity_preserving_policy();
-    rc = qvi_map_affinity_preserving(
-        map, policy, m_cpu_affinities, cpusets
-    );
-    if (rc != QV_SUCCESS) return rc;
+    if (optimal) {
+        rc = qvi_map_affinity_optimal(map, m_cpu_affinities, cpusets);
+        if (rc != QV_SUCCESS) return rc;
+#if QVI_DEBUG_MODE != 0
+        // Report how the optimal mapping compares with the greedy one.
+        qvi_map_t greedy;
+        rc = qvi_map_affinity_preserving(
+            greedy, policy, m_cpu_affinities, cpusets
+        );
+        if (rc != QV_SUCCESS) return rc;
+        qvi_log_debug(
+            "Affinity overlap: optimal={} greedy={}",
+            qvi_map_overlap(map, m_cpu_affinities, cpusets),
+            qvi_map_overlap(greedy, m_cpu_affinities, cpusets)
+        );
+#endif
+    }
+    else {
+        rc = qvi_map_affinity_preserving(
+            map, policy, m_cpu_affinities, cpusets
+        );
+        if (rc != QV_SUCCESS) return rc;
+    }
     // Make sure that we mapped all the tasks. If not, this is a bug.
     if (qvi_map_nfids_mapped(map) != m_group_size) {
         qvi_abort();
@@ -445,15 +621,15 @@ qvi_hwsplit::split_affinity_preserving_pass1(void)
  */
 // TODO(skg) This needs more work.
 int
-qvi_hwsplit::split_affinity_preserving(void)
-{
-    int rc = split_affinity_preserving_pass1();
+qvi_hwsplit::split_affinity_preserving(
+    bool optimal
+) {
+    int rc = split_affinity_preserving_pass1(optimal);
     if (rc != QV_SUCCESS) return rc;
     // Finally, split the devices.
-    return split_devices_affinity_preserving();
+    return split_devices_affinity_preserving(m_cpu_affinities);
 }
 
-// TODO(skg) Add device splitting.
 int
 qvi_hwsplit::split_packed(void)
 {
@@ -471,12 +647,14 @@ qvi_hwsplit::split_packed(void)
         qvi_abort();
     }
     // Update the hardware pools and colors to reflect the new mapping.
-    return apply_cpuset_mapping(
+    rc = apply_cpuset_mapping(
         m_rmi.hwloc(), map, cpusets, m_hwpools, m_colors
     );
+    if (rc != QV_SUCCESS) return rc;
+    // Place devices with the pieces nearest to them.
+    return split_devices_by_piece(map, cpusets, false);
 }
 
-// TODO(skg) Add device splitting.
 int
 qvi_hwsplit::split_spread(void)
 {
@@ -494,9 +672,139 @@ qvi_hwsplit::split_spread(void)
         qvi_abort();
     }
     // Update the hardware pools and colors to reflect the new mapping.
-    return apply_cpuset_mapping(
+    rc = apply_cpuset_mapping(
+        m_rmi.hwloc(), map, cpusets, m_hwpools, m_colors
+    );
+    if (rc != QV_SUCCESS) return rc;
+    // Deal devices across the pieces, alternating between NUMA domains.
+    return split_devices_by_piece(map, cpusets, true);
+}
+
+int
+qvi_hwsplit::split_cpukind(
+    bool balanced
+) {
+    // Core kinds only make sense when splitting the host's cpuset.
+    if (m_split_at_type != QV_HW_OBJ_LAST) return QV_ERR_NOT_SUPPORTED;
+    // cpusets used for mapping.
+    qvi_hwloc_bitmaps cpusets;
+    int rc = m_cpukind_cpusets(balanced, cpusets);
+    if (rc != QV_SUCCESS) return rc;
+    // Maintains the mapping between task (consumer) IDs and resource IDs.
+    qvi_map_t map;
+    rc = qvi_map_packed(map, m_group_size, cpusets);
+    if (rc != QV_SUCCESS) return rc;
+    // Make sure that we mapped all the tasks. If not, this is a bug.
+    if (qvi_map_nfids_mapped(map) != m_group_size) {
+        qvi_abort();
+    }
+    // Update the hardware pools and colors to reflect the new mapping.
+    rc = apply_cpuset_mapping(
+        m_rmi.hwloc(), map, cpusets, m_hwpools, m_colors
+    );
+    if (rc != QV_SUCCESS) return rc;
+    // Place devices with the pieces nearest to them.
+    return split_devices_by_piece(map, cpusets, false);
+}
+
+/**
+ * Divides nunits among members in proportion to their positive weights using
+ * the largest remainder method. Every member receives at least one unit, and
+ * all units are handed out. Requires nunits >= weights.size().
+ */
+static std::vector<uint_t>
+apportion(
+    const std::vector<int> &weights,
+    uint_t nunits
+) {
+    const uint_t nmembers = weights.size();
+    const double total = std::accumulate(weights.begin(), weights.end(), 0.0);
+    // Exact proportional shares, then whole units of at least one each.
+    std::vector<double> quotas(nmembers);
+    std::vector<uint_t> result(nmembers);
+    uint_t nassigned = 0;
+    for (uint_t i = 0; i < nmembers; ++i) {
+        quotas[i] = nunits * (weights[i] / total);
+        result[i] = std::max(1u, uint_t(quotas[i]));
+        nassigned += result[i];
+    }
+    // Raising members to one unit may overshoot: take units back from the
+    // members furthest above their quota.
+    while (nassigned > nunits) {
+        uint_t over = nmembers;
+        for (uint_t i = 0; i < nmembers; ++i) {
+            if (result[i] == 1) continue;
+            if (over == nmembers ||
+                result[i] - quotas[i] > result[over] - quotas[over]) {
+                over = i;
+            }
+        }
+        result[over]--;
+        nassigned--;
+    }
+    // Hand out the remaining units to the members furthest below their quota.
+    while (nassigned < nunits) {
+        uint_t under = 0;
+        for (uint_t i = 1; i < nmembers; ++i) {
+            if (quotas[i] - result[i] > quotas[under] - result[under]) {
+                under = i;
+            }
+        }
+        result[under]++;
+        nassigned++;
+    }
+    return result;
+}
+
+int
+qvi_hwsplit::split_weighted(void)
+{
+    // Weighted pieces only make sense when splitting the host's cpuset.
+    if (m_split_at_type != QV_HW_OBJ_LAST) return QV_ERR_NOT_SUPPORTED;
+    // Hand out whole cores when every member's share amounts to at least one
+    // of them, PUs otherwise. Rounding a smaller share up to a whole core
+    // would skew the others' shares away from their weights.
+    qvi_hwloc_bitmaps units;
+    int rc = m_rmi.hwloc().get_core_cpusets_in_cpuset(
+        m_cpuset().cdata(), units
+    );
+    if (rc != QV_SUCCESS) return rc;
+    const uint64_t total_weight = std::accumulate(
+        m_weights.begin(), m_weights.end(), 0ull
+    );
+    const uint64_t min_weight = *std::min_element(
+        m_weights.begin(), m_weights.end()
+    );
+    if (units.size() * min_weight < total_weight) {
+        units.clear();
+        int pu;
+        hwloc_bitmap_foreach_begin(pu, m_cpuset().cdata())
+            qvi_hwloc_bitmap unit;
+            hwloc_bitmap_only(unit.data(), pu);
+            units.push_back(unit);
+        hwloc_bitmap_foreach_end();
+    }
+    if (units.size() < m_group_size) return QV_ERR_SPLIT;
+    // Give each member a contiguous run of units sized by its weight.
+    const std::vector<uint_t> nunits = apportion(m_weights, units.size());
+    qvi_hwloc_bitmaps cpusets(m_group_size);
+    qvi_map_t map;
+    for (uint_t i = 0, uniti = 0; i < m_group_size; ++i) {
+        for (uint_t j = 0; j < nunits[i]; ++j, ++uniti) {
+            const int orrc = hwloc_bitmap_or(
+                cpusets[i].data(), cpusets[i].cdata(), units[uniti].cdata()
+            );
+            if (qvi_unlikely(orrc != 0)) return QV_ERR_HWLOC;
+        }
+        map.insert(i, i);
+    }
+    // Update the hardware pools and colors to reflect the new mapping.
+    rc = apply_cpuset_mapping(
         m_rmi.hwloc(), map, cpusets, m_hwpools, m_colors
     );
+    if (rc != QV_SUCCESS) return rc;
+    // Devices follow the new pieces.
+    return split_devices_affinity_preserving(cpusets);
 }
 
 /**
@@ -528,6 +836,9 @@ clamp_colors(
 int
 qvi_hwsplit::m_split(void)
 {
+    // Weighted splits ignore colors: every member gets its own piece.
+    if (!m_weights.empty()) return split_weighted();
+
     int rc = QV_SUCCESS;
     bool auto_split = false;
     // Make sure that the supplied colors are consistent and determine the type
@@ -573,6 +884,12 @@ qvi_hwsplit::m_split(void)
             return split_packed();
         case QV_SCOPE_SPLIT_SPREAD:
             return split_spread();
+        case QV_SCOPE_SPLIT_CPUKIND_PERF_FIRST:
+            return split_cpukind(false);
+        case QV_SCOPE_SPLIT_CPUKIND_BALANCED:
+            return split_cpukind(true);
+        case QV_SCOPE_SPLIT_AFFINITY_OPTIMAL:
+            return split_affinity_preserving(true);
         default:
             rc = QV_ERR_INVLD_ARG;
             break;
@@ -580,32 +897,97 @@ qvi_hwsplit::m_split(void)
     return rc;
 }
 
+/**
+ * A member's contribution to a split.
+ */
+struct qvi_hwsplit_input {
+    /** The member's task ID. */
+    pid_t tid = 0;
+    /** The member's current CPU affinity. */
+    qvi_hwloc_bitmap affinity;
+    /** The member's color. */
+    int color = 0;
+    /** The member's weight. */
+    int weight = 0;
+    /** Digest of the member's parent hardware pool. */
+    uint64_t pool_digest = 0;
+    /** ID of the member's memoized result for this split, or -1. */
+    int64_t memo_id = -1;
+
+    template <class Archive>
+    void
+    serialize(
+        Archive &archive
+    ) {
+        archive(tid, affinity, color, weight, pool_digest, memo_id);
+    }
+};
+
+/**
+ * Returns a digest (64-bit FNV-1a) of the provided hardware pool's serialized
+ * form. Equal pools built the same way have equal digests.
+ */
+static int
+hwpool_digest(
+    const qvi_hwpool &hwpool,
+    uint64_t &digest
+) {
+    qvi_bbuff buff;
+    const int rc = buff.pack(hwpool);
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+
+    const byte_t *bytes = static_cast<const byte_t *>(buff.cdata());
+    digest = 14695981039346656037ULL;
+    for (size_t i = 0; i < buff.size(); ++i) {
+        digest = (digest ^ bytes[i]) * 1099511628211ULL;
+    }
+    return QV_SUCCESS;
+}
+
 int
-qvi_hwsplit::m_gather_split_data(
+qvi_hwsplit::m_allgather_split_data(
     const qvi_group &group,
-    int rootid,
     qvi_hwsplit &hwsplit,
-    int color
+    int color,
+    int64_t memo_id,
+    int64_t &memo_hit,
+    bool &replicated
 ) {
-    int rc = qvi_coll::gather(
-        group, rootid, qvi_task::mytid(), hwsplit.m_group_tids
-    );
+    qvi_hwsplit_input mine;
+    mine.tid = qvi_task::mytid();
+    mine.affinity = hwsplit.m_cpu_affinity;
+    mine.color = color;
+    mine.weight = hwsplit.m_weight;
+    mine.memo_id = memo_id;
+    int rc = hwpool_digest(hwsplit.m_hwpool, mine.pool_digest);
     if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
 
-    rc = qvi_coll::gather(
-        group, rootid, hwsplit.m_cpu_affinity, hwsplit.m_cpu_affinities
-    );
+    std::vector<qvi_hwsplit_input> inputs;
+    rc = qvi_coll::allgather(group, mine, inputs);
     if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
 
-    rc = qvi_coll::gather(
-        group, rootid, color, hwsplit.m_colors
-    );
-    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
-    // The root creates new hardware pools so it can modify them freely.
-    if (group.rank() == rootid) {
-        hwsplit.m_hwpools.resize(group.size());
+    hwsplit.m_reserve();
+    // Weights are only needed by weighted splits.
+    if (hwsplit.m_weight > 0) {
+        hwsplit.m_weights.resize(inputs.size());
     }
-    return rc;
+    replicated = true;
+    memo_hit = inputs[0].memo_id;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        hwsplit.m_group_tids[i] = inputs[i].tid;
+        hwsplit.m_cpu_affinities[i] = inputs[i].affinity;
+        hwsplit.m_colors[i] = inputs[i].color;
+        if (hwsplit.m_weight > 0) {
+            hwsplit.m_weights[i] = inputs[i].weight;
+        }
+        if (inputs[i].pool_digest != inputs[0].pool_digest) {
+            replicated = false;
+        }
+        if (inputs[i].memo_id != memo_hit) {
+            memo_hit = -1;
+        }
+    }
+    return QV_SUCCESS;
 }
 
 int
@@ -628,23 +1010,42 @@ qvi_hwsplit::split(
     uint_t npieces,
     int color,
     qv_hw_obj_type_t maybe_obj_type,
+    int64_t memo_id,
+    int64_t *memo_hit,
     int *colorp,
-    qvi_hwpool &result
+    qvi_hwpool &result,
+    int weight
 ) {
+    *memo_hit = -1;
     const qvi_group &pgroup = parent->group();
     // Everyone create a hardware split object.
     qvi_hwsplit hwsplit(
         parent, pgroup.size(), npieces, maybe_obj_type
     );
+    hwsplit.m_weight = weight;
     // First consolidate the provided information, as this is coming from a
     // SPMD-like context (e.g., splitting a resource shared by MPI processes).
-    // In most cases it is easiest to have a single task calculate the split
-    // based on global knowledge and later redistribute the calculated result to
-    // its group members. Note that aggregated data are only valid for the task
-    // whose id is equal to qvi_hwsplit::s_root after gather has completed.
-    int rc = m_gather_split_data(pgroup, s_root, hwsplit, color);
+    // The split is a pure function of these data and the parent's hardware
+    // pool, so share them with every member.
+    bool replicated = false;
+    int rc = m_allgather_split_data(
+        pgroup, hwsplit, color, memo_id, *memo_hit, replicated
+    );
     if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
-    // The root does this calculation.
+    // Every member found the same memoized result, so the caller reuses it.
+    if (*memo_hit >= 0) return QV_SUCCESS;
+    // If every member holds the same parent hardware pool, then everyone
+    // computes the same split locally and keeps only its own piece. Since the
+    // result is identical everywhere, so is any error.
+    if (replicated) {
+        rc = hwsplit.m_split();
+        if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+        *colorp = hwsplit.m_colors.at(pgroup.rank());
+        result = hwsplit.m_hwpools.at(pgroup.rank());
+        return QV_SUCCESS;
+    }
+    // Otherwise, the root's hardware pool is authoritative: the root
+    // calculates the split and redistributes the result to its members.
     int rc2 = QV_SUCCESS;
     if (pgroup.rank() == s_root) {
         rc2 = hwsplit.m_split();
@@ -669,7 +1070,6 @@ qvi_hwsplit::thread_split(
     int *kcolors,
     uint_t k,
     qv_hw_obj_type_t maybe_obj_type,
-    std::vector<int> &kcolorps,
     std::vector<qvi_hwpool> &khwpools
 ) {
     const uint_t group_size = k;
@@ -700,7 +1100,6 @@ qvi_hwsplit::thread_split(
     if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
     // Now populate the hardware pools as the result.
     khwpools = hwsplit.m_hwpools;
-    kcolorps = hwsplit.m_colors;
     return QV_SUCCESS;
 }
 
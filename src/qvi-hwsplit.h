@@ -83,6 +83,13 @@ private:
     std::vector<int> m_colors;
     /** Vector of task affinities. */
     qvi_hwloc_bitmaps m_cpu_affinities;
+    /**
+     * The split member's weight. Positive values request a weighted split,
+     * where each member's piece is sized in proportion to its weight.
+     */
+    int m_weight = 0;
+    /** Vector of member weights, gathered only for weighted splits. */
+    std::vector<int> m_weights;
     /**
      * Resizes the relevant containers to make
      * room for |group size| number of elements.
@@ -105,6 +112,16 @@ private:
     m_split_cpuset(
         qvi_hwloc_bitmaps &result
     ) const;
+    /**
+     * Splits the base cpuset into split_size pieces by core kind. When
+     * balanced, every piece gets an equal share of each kind. Otherwise, cores
+     * are handed out from the most performant kind first.
+     */
+    int
+    m_cpukind_cpusets(
+        bool balanced,
+        qvi_hwloc_bitmaps &result
+    ) const;
     /** Returns device affinities that are part of the split. */
     int
     m_osdev_cpusets(
@@ -118,13 +135,20 @@ private:
     /** Releases all devices contained in the hardware split. */
     int
     m_release_devices(void);
-    /** Gathers group-level split data to the specified root. */
+    /**
+     * Shares group-level split data among all members. replicated is set when
+     * every member holds the same parent hardware pool, so that each can
+     * compute the split locally with identical results. memo_hit is set to
+     * memo_id if every member provided the same one, and to -1 otherwise.
+     */
     static int
-    m_gather_split_data(
+    m_allgather_split_data(
         const qvi_group &group,
-        int rootid,
         qvi_hwsplit &hwsplit,
-        int color
+        int color,
+        int64_t memo_id,
+        int64_t &memo_hit,
+        bool &replicated
     );
     /**
      * Scatters split results from the specified root to other group members.
@@ -140,40 +164,81 @@ private:
     /** */
     qvi_map_fn_t
     affinity_preserving_policy(void) const;
-    /** */
+    /**
+     * Maps tasks to cpusets by affinity. The optimal flag selects the
+     * overlap-maximizing mapper over the greedy one.
+     */
     int
-    split_affinity_preserving_pass1(void);
+    split_affinity_preserving_pass1(
+        bool optimal
+    );
     /** User-defined split. */
     int
     split_user_defined(void);
     /** Affinity preserving split. */
     int
-    split_affinity_preserving(void);
+    split_affinity_preserving(
+        bool optimal = false
+    );
     /** */
     int
     split_packed(void);
     /** */
     int
     split_spread(void);
+    /** Packed split over cpusets formed according to core kinds. */
+    int
+    split_cpukind(
+        bool balanced
+    );
     /** Straightforward user-defined device splitting. */
     int
     split_devices_user_defined(void);
-    /** Affinity preserving device splitting. */
+    /**
+     * Assigns each of the parent's devices to one of the provided pieces and
+     * gives tasks the devices of their pieces. Packed places a device with the
+     * piece it overlaps most; spread does the same, but also evens out the
+     * number of devices per piece, taking devices from alternating NUMA
+     * domains. See qvi_map_devices().
+     */
+    int
+    split_devices_by_piece(
+        const qvi_map_t &map,
+        const qvi_hwloc_bitmaps &cpusets,
+        bool spread
+    );
+    /** Weighted split: one piece per member, sized by the member weights. */
     int
-    split_devices_affinity_preserving(void);
+    split_weighted(void);
+    /**
+     * Affinity preserving device splitting. Devices are
+     * mapped to pools based on the provided affinities.
+     */
+    int
+    split_devices_affinity_preserving(
+        const qvi_hwloc_bitmaps &affinities
+    );
     /** Splits aggregate scope data. This can only be called by the root. */
     int
     m_split(void);
 public:
-    /** Performs a collective split. */
+    /**
+     * Performs a collective split. memo_id is the ID of the caller's memoized
+     * result for this split, or -1. If every member provides the same ID, it
+     * is returned through memo_hit and no split is performed. Otherwise,
+     * memo_hit is set to -1.
+     */
     static int
     split(
         qv_scope_t *parent,
         uint_t npieces,
         int color,
         qv_hw_obj_type_t maybe_obj_type,
+        int64_t memo_id,
+        int64_t *memo_hit,
         int *colorp,
-        qvi_hwpool &result
+        qvi_hwpool &result,
+        int weight = 0
     );
     /** Performs a thread-split operation, returns relevant hardware pools. */
     static int
@@ -183,7 +248,6 @@ public:
         int *kcolors,
         uint_t k,
         qv_hw_obj_type_t maybe_obj_type,
-        std::vector<int> &kcolorps,
         std::vector<qvi_hwpool> &khwpools
     );
 };
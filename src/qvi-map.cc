@@ -1,6 +1,6 @@
 /* -*- Mode: C++; c-basic-offset:4; indent-tabs-mode:nil -*- */
 /*
- * Copyright (c) 2022-2024 Triad National Security, LLC
+ * Copyright (c) 2022-2025 Triad National Security, LLC
  *                         All rights reserved.
  *
  * This file is part of the quo-vadis project. See the LICENSE file at the
@@ -14,30 +14,74 @@
 #include "qvi-map.h"
 
 /**
- * Performs a k-set intersection of the sets included in the provided set map.
+ * Calls fn with the index of each set bit in the provided row, in ascending
+ * order.
+ */
+template <typename Fn>
+static void
+for_each_bit(
+    const uint64_t *row,
+    uint_t nwords,
+    Fn fn
+) {
+    for (uint_t w = 0; w < nwords; ++w) {
+        uint64_t word = row[w];
+        while (word) {
+            const uint_t bit = __builtin_ctzll(word);
+            fn(w * 64 + bit);
+            word &= word - 1;
+        }
+    }
+}
+
+/**
+ * Returns the number of set bits in the provided row.
+ */
+static uint_t
+row_count(
+    const uint64_t *row,
+    uint_t nwords
+) {
+    uint_t n = 0;
+    for (uint_t w = 0; w < nwords; ++w) {
+        n += __builtin_popcountll(row[w]);
+    }
+    return n;
+}
+
+/**
+ * Performs a k-set intersection of the sets included in the provided set map:
+ * the consumer IDs of the first resource with any consumers that also have
+ * affinity to some other resource.
  */
 static int
 k_set_intersection(
     const qvi_map_shaffinity_t &smap,
-    std::set<uint_t> &result
+    std::vector<uint64_t> &result
 ) {
-    result.clear();
+    const uint_t nres = smap.nres();
+    const uint_t nwords = smap.nwords();
+    result.assign(nwords, 0);
+    // Find the first resource with consumers. Resources without
+    // consumers do not take part in the intersection.
+    uint_t first = 0;
+    while (first < nres && row_count(smap.row(first), nwords) == 0) {
+        first++;
+    }
     // Nothing to do.
-    if (smap.size() <= 1) {
+    if (first >= nres) {
         return QV_SUCCESS;
     }
-    // Remember that this is an ordered map.
-    auto setai = smap.cbegin();
-    auto setbi = std::next(setai);
-    while (setbi != smap.cend()) {
-        std::set_intersection(
-            setai->second.cbegin(),
-            setai->second.cend(),
-            setbi->second.cbegin(),
-            setbi->second.cend(),
-            std::inserter(result, result.begin())
-        );
-        setbi = std::next(setbi);
+    // Union of the remaining rows, then intersect with the first row.
+    for (uint_t rid = first + 1; rid < nres; ++rid) {
+        const uint64_t *const row = smap.row(rid);
+        for (uint_t w = 0; w < nwords; ++w) {
+            result[w] |= row[w];
+        }
+    }
+    const uint64_t *const frow = smap.row(first);
+    for (uint_t w = 0; w < nwords; ++w) {
+        result[w] &= frow[w];
     }
     return QV_SUCCESS;
 }
@@ -51,45 +95,210 @@ k_set_intersection(
 static int
 make_shared_affinity_map_disjoint(
     qvi_map_shaffinity_t &samap,
-    const std::set<uint_t> &interids
+    const std::vector<uint64_t> &interids
 ) {
+    const uint_t nwords = samap.nwords();
     // Number of intersecting consumer IDs.
-    const uint_t ninter = interids.size();
-    // Number of resources.
-    const uint_t nres = samap.size();
+    const uint_t ninter = row_count(interids.data(), nwords);
+    // Number of resources with consumers.
+    uint_t nres = 0;
+    for (uint_t rid = 0; rid < samap.nres(); ++rid) {
+        if (samap.count(rid) != 0) nres++;
+    }
     // Max intersecting consumer IDs per resource.
     const uint_t maxcpr = qvi_map_maxiperk(ninter, nres);
-
-    qvi_map_shaffinity_t dmap;
-    // First remove all IDs that intersect from the provided set map.
-    for (const auto &mi: samap) {
-        const uint_t rid = mi.first;
-        std::set_difference(
-            mi.second.cbegin(),
-            mi.second.cend(),
-            interids.cbegin(),
-            interids.cend(),
-            std::inserter(dmap[rid], dmap[rid].begin())
-        );
-    }
-    // Copy IDs into a set we can modify.
-    std::set<uint_t> coii(interids);
-    // Assign disjoint IDs to relevant resources.
-    for (const auto &mi: samap) {
-        const uint_t rid = mi.first;
+    // Intersecting IDs that have yet to be assigned.
+    std::vector<uint64_t> coii(interids);
+    uint_t ncoii = ninter;
+    // Candidates for the current resource: its intersecting IDs still unassigned.
+    std::vector<uint64_t> cand(nwords);
+    for (uint_t rid = 0; rid < samap.nres(); ++rid) {
+        uint64_t *const row = samap.row(rid);
+        // Remove all IDs that intersect from the resource, remembering
+        // which of them are still available for assignment.
+        for (uint_t w = 0; w < nwords; ++w) {
+            cand[w] = row[w] & coii[w];
+            row[w] &= ~interids[w];
+        }
+        // Assign disjoint IDs to the resource.
         uint_t nids = 0;
-        for (const auto &cid : mi.second) {
-            if (coii.find(cid) == coii.end()) continue;
-            dmap[rid].insert(cid);
-            coii.erase(cid);
-            if (++nids == maxcpr || coii.empty()) break;
+        for (uint_t w = 0; w < nwords && nids < maxcpr && ncoii; ++w) {
+            uint64_t word = cand[w];
+            while (word && nids < maxcpr && ncoii) {
+                const uint64_t bit = word & -word;
+                row[w] |= bit;
+                coii[w] &= ~bit;
+                word &= word - 1;
+                nids++;
+                ncoii--;
+            }
         }
     }
-    // Update the provided set map.
-    samap = dmap;
     return QV_SUCCESS;
 }
 
+/**
+ * Indexes resources by the bits they contain. Resources with infinite bitmaps
+ * cannot be indexed this way and are listed separately.
+ */
+struct resource_index {
+    /** Maps a bit to the IDs of the resources containing it. */
+    std::vector<std::vector<uint_t>> bit2res;
+    /** IDs of resources with infinite bitmaps. */
+    std::vector<uint_t> infinite;
+    /** Constructor. */
+    explicit resource_index(
+        const qvi_hwloc_bitmaps &tores
+    ) {
+        for (uint_t rid = 0; rid < tores.size(); ++rid) {
+            hwloc_const_bitmap_t res = tores[rid].cdata();
+            if (hwloc_bitmap_weight(res) == -1) {
+                infinite.push_back(rid);
+                continue;
+            }
+            const int last = hwloc_bitmap_last(res);
+            if (last >= int(bit2res.size())) bit2res.resize(last + 1);
+            int bit;
+            hwloc_bitmap_foreach_begin(bit, res)
+                bit2res[bit].push_back(rid);
+            hwloc_bitmap_foreach_end();
+        }
+    }
+};
+
+/**
+ * Minimum-cost flow solver using the primal-dual method: shortest paths with
+ * potentials, then augmentation along all of them. Edge costs must be
+ * non-negative.
+ */
+struct min_cost_flow {
+private:
+    struct edge {
+        uint_t to;
+        int64_t cap;
+        int64_t cost;
+    };
+    std::vector<edge> m_edges;
+    std::vector<std::vector<uint_t>> m_adj;
+    /** Next edge to try from each node while augmenting. */
+    std::vector<uint_t> m_arc;
+    /** Nodes on the current augmenting path. */
+    std::vector<bool> m_visited;
+    /**
+     * Pushes up to limit units of flow from u to t along edges with zero
+     * reduced cost. Returns the amount of flow pushed.
+     */
+    int64_t
+    m_augment(
+        uint_t u,
+        uint_t t,
+        int64_t limit,
+        const std::vector<int64_t> &pot
+    ) {
+        if (u == t) return limit;
+        m_visited[u] = true;
+        for (uint_t &i = m_arc[u]; i < m_adj[u].size(); ++i) {
+            const uint_t eid = m_adj[u][i];
+            edge &e = m_edges[eid];
+            if (e.cap == 0 || m_visited[e.to]) continue;
+            if (e.cost + pot[u] - pot[e.to] != 0) continue;
+            const int64_t pushed = m_augment(
+                e.to, t, std::min(limit, e.cap), pot
+            );
+            if (pushed == 0) continue;
+            e.cap -= pushed;
+            m_edges[eid ^ 1].cap += pushed;
+            m_visited[u] = false;
+            return pushed;
+        }
+        m_visited[u] = false;
+        return 0;
+    }
+public:
+    /** Constructor. */
+    explicit min_cost_flow(
+        uint_t nnodes
+    ) : m_adj(nnodes) { }
+    /** Adds an edge and returns its ID. */
+    uint_t
+    add_edge(
+        uint_t from,
+        uint_t to,
+        int64_t cap,
+        int64_t cost
+    ) {
+        const uint_t eid = m_edges.size();
+        m_adj[from].push_back(eid);
+        m_edges.push_back({to, cap, cost});
+        m_adj[to].push_back(eid + 1);
+        m_edges.push_back({from, 0, -cost});
+        return eid;
+    }
+    /** Returns the flow through the given edge. */
+    int64_t
+    flow(
+        uint_t eid
+    ) const {
+        return m_edges[eid + 1].cap;
+    }
+    /**
+     * Sends up to need units of flow from s to t at minimum cost. Returns the
+     * amount of flow sent.
+     */
+    int64_t
+    solve(
+        uint_t s,
+        uint_t t,
+        int64_t need
+    ) {
+        static constexpr int64_t inf = INT64_MAX;
+        const uint_t nnodes = m_adj.size();
+        std::vector<int64_t> pot(nnodes, 0), dist(nnodes);
+        m_arc.resize(nnodes);
+        m_visited.resize(nnodes);
+        using qent = std::pair<int64_t, uint_t>;
+        int64_t sent = 0;
+        while (sent < need) {
+            std::fill(dist.begin(), dist.end(), inf);
+            std::priority_queue<qent, std::vector<qent>, std::greater<qent>> pq;
+            dist[s] = 0;
+            pq.push({0, s});
+            while (!pq.empty()) {
+                const auto [d, u] = pq.top();
+                pq.pop();
+                if (d != dist[u]) continue;
+                // Nodes farther away than the sink cannot improve the path.
+                if (u == t) break;
+                for (const uint_t eid : m_adj[u]) {
+                    const edge &e = m_edges[eid];
+                    if (e.cap == 0) continue;
+                    const int64_t nd = d + e.cost + pot[u] - pot[e.to];
+                    if (nd < dist[e.to]) {
+                        dist[e.to] = nd;
+                        pq.push({nd, e.to});
+                    }
+                }
+            }
+            // No more augmenting paths.
+            if (dist[t] == inf) break;
+            // Capping at the sink distance keeps reduced costs non-negative
+            // for nodes that were not settled.
+            for (uint_t v = 0; v < nnodes; ++v) {
+                pot[v] += std::min(dist[v], dist[t]);
+            }
+            // Push flow along every shortest path found in this round.
+            std::fill(m_arc.begin(), m_arc.end(), 0);
+            while (sent < need) {
+                std::fill(m_visited.begin(), m_visited.end(), false);
+                const int64_t pushed = m_augment(s, t, need - sent, pot);
+                if (pushed == 0) break;
+                sent += pushed;
+            }
+        }
+        return sent;
+    }
+};
+
 uint_t
 qvi_map_maxfit(
     uint_t max_chunk,
@@ -122,7 +331,7 @@ qvi_map_fid_mapped(
     const qvi_map_t &map,
     uint_t cid
 ) {
-    return map.find(cid) != map.end();
+    return map.contains(cid);
 }
 
 int
@@ -132,20 +341,15 @@ qvi_map_colors(
     const qvi_hwloc_bitmaps &tres
 ) {
     // Note: the array index i of fcolors is the color requested by task i.
-    // Determine the number of distinct colors provided in the colors array.
-    std::set<int> color_set(fcolors.begin(), fcolors.end());
-    const uint_t nfrom = color_set.size();
-    // For convenience, we convert the set to a vector for later use.
-    std::vector<int> color_vec(color_set.begin(), color_set.end());
-    // Maps a given color to its corresponding set index.
-    // For example, given colors = {3, 5, 3, 4}, we get the following:
-    // color_set = {3, 4, 5}, color_vec = {3, 4, 5}
-    // color_set_index (csi) = {0, 1, 2}, since we have three distinct colors.
-    // color2csi = {3:0, 4:1, 5:2}.
-    std::map<int, uint_t> color2csi;
-    for (uint_t i = 0; i < color_vec.size(); ++i) {
-        color2csi.insert({color_vec[i], i});
-    }
+    // Determine the distinct colors provided in the colors array, in order.
+    // For example, given colors = {3, 5, 3, 4}, we get color_vec = {3, 4, 5},
+    // so a color's set index (csi) is its position in color_vec.
+    std::vector<int> color_vec(fcolors);
+    std::sort(color_vec.begin(), color_vec.end());
+    color_vec.erase(
+        std::unique(color_vec.begin(), color_vec.end()), color_vec.end()
+    );
+    const uint_t nfrom = color_vec.size();
     // Create a mapping of color_set indices to cpuset indices.
     qvi_map_t csi2cpui;
     // We map packed here because we are assuming that like or near colors
@@ -156,9 +360,11 @@ qvi_map_colors(
     for (uint_t fid = 0; fid < fcolors.size(); ++fid) {
         // Already mapped (potentially by some other mapper).
         if (qvi_map_fid_mapped(map, fid)) continue;
-        const uint_t csi = color2csi.at(fcolors[fid]);
+        const uint_t csi = std::lower_bound(
+            color_vec.begin(), color_vec.end(), fcolors[fid]
+        ) - color_vec.begin();
         const uint_t tid = csi2cpui.at(csi);
-        map.insert({fid, tid});
+        map.insert(fid, tid);
     }
     return rc;
 }
@@ -183,7 +389,7 @@ qvi_map_packed(
             // Already mapped (potentially by some other mapper).
             if (qvi_map_fid_mapped(map, fid)) continue;
             // Else map the consumer to the resource ID.
-            map.insert({fid, tid});
+            map.insert(fid, tid);
             nmapped++;
         }
     }
@@ -204,7 +410,7 @@ qvi_map_spread(
         // Already mapped (potentially by some other mapper).
         if (qvi_map_fid_mapped(map, fid)) continue;
         // Mod to loop around 'to resource' IDs.
-        map.insert({fid, (tid++) % ntres});
+        map.insert(fid, (tid++) % ntres);
     }
     return QV_SUCCESS;
 }
@@ -214,14 +420,13 @@ qvi_map_disjoint_affinity(
     qvi_map_t &map,
     const qvi_map_shaffinity_t &damap
 ) {
-    for (auto &tidfids : damap) {
-        const int tid = tidfids.first;
-        for (const auto fid : damap.at(tid)) {
+    for (uint_t tid = 0; tid < damap.nres(); ++tid) {
+        for_each_bit(damap.row(tid), damap.nwords(), [&](uint_t fid) {
             // Already mapped (potentially by some other mapper).
-            if (qvi_map_fid_mapped(map, fid)) continue;
+            if (qvi_map_fid_mapped(map, fid)) return;
             // Map the consumer ID to its resource ID.
-            map.insert({fid, tid});
-        }
+            map.insert(fid, tid);
+        });
     }
     return QV_SUCCESS;
 }
@@ -237,14 +442,48 @@ qvi_map_calc_shaffinity(
     // Number of resource we are mapping to.
     const uint_t nres = tores.size();
 
+    res_affinity_map.reset(nres, ncon);
+    // Index the resources by the bits they contain, so a consumer's resources
+    // are found by walking its own bits instead of testing every resource.
+    resource_index index(tores);
+    // Consumers frequently share an affinity (e.g., they are all unbound), so
+    // remember the resources of each distinct affinity we have seen.
+    const auto bitmap_less = [](
+        hwloc_const_bitmap_t a, hwloc_const_bitmap_t b
+    ) {
+        return hwloc_bitmap_compare(a, b) < 0;
+    };
+    std::map<
+        hwloc_const_bitmap_t, std::vector<uint_t>, decltype(bitmap_less)
+    > aff2res(bitmap_less);
+    // Stamps resources already found for the current distinct affinity.
+    std::vector<uint_t> stamps(nres, UINT_MAX);
+
     for (uint_t cid = 0; cid < ncon; ++cid) {
-        for (uint_t rid = 0; rid < nres; ++rid) {
-            const int intersects = hwloc_bitmap_intersects(
-                faffs.at(cid).cdata(), tores.at(rid).cdata()
-            );
-            if (intersects) {
-                res_affinity_map[rid].insert(cid);
+        hwloc_const_bitmap_t aff = faffs[cid].cdata();
+        auto got = aff2res.find(aff);
+        if (got == aff2res.end()) {
+            const uint_t stamp = aff2res.size();
+            std::vector<uint_t> rids;
+            // Bounded by the indexed bits, since aff may be infinite.
+            const int nbits = index.bit2res.size();
+            for (int bit = hwloc_bitmap_first(aff); bit >= 0 && bit < nbits;
+                 bit = hwloc_bitmap_next(aff, bit)) {
+                for (const uint_t rid : index.bit2res[bit]) {
+                    if (stamps[rid] == stamp) continue;
+                    stamps[rid] = stamp;
+                    rids.push_back(rid);
+                }
+            }
+            for (const uint_t rid : index.infinite) {
+                if (hwloc_bitmap_intersects(aff, tores[rid].cdata())) {
+                    rids.push_back(rid);
+                }
             }
+            got = aff2res.insert({aff, rids}).first;
+        }
+        for (const uint_t rid : got->second) {
+            res_affinity_map.set(rid, cid);
         }
     }
     return QV_SUCCESS;
@@ -263,7 +502,7 @@ qvi_map_affinity_preserving(
     // Maps resource IDs to consumer IDs with shared affinity.
     qvi_map_shaffinity_t res_affinity_map;
     // Stores the consumer IDs that all share affinity with a split resource.
-    std::set<uint_t> affinity_intersection;
+    std::vector<uint64_t> affinity_intersection;
     // Determine the consumer IDs that have shared affinity with the resources.
     rc = qvi_map_calc_shaffinity(faffs, tores, res_affinity_map);
     if (rc != QV_SUCCESS) goto out;
@@ -272,7 +511,9 @@ qvi_map_affinity_preserving(
     if (rc != QV_SUCCESS) goto out;
     // Now make a mapping decision based on the intersection size.
     // Completely disjoint sets.
-    if (affinity_intersection.size() == 0) {
+    if (row_count(
+            affinity_intersection.data(), res_affinity_map.nwords()
+        ) == 0) {
         rc = qvi_map_disjoint_affinity(map, res_affinity_map);
         if (rc != QV_SUCCESS) goto out;
     }
@@ -300,6 +541,173 @@ out:
     return rc;
 }
 
+int
+qvi_map_affinity_optimal(
+    qvi_map_t &map,
+    const qvi_hwloc_bitmaps &faffs,
+    const qvi_hwloc_bitmaps &tores
+) {
+    const uint_t ncon = faffs.size();
+    const uint_t nres = tores.size();
+    if (ncon == 0) return QV_SUCCESS;
+    if (nres == 0) return QV_ERR_INVLD_ARG;
+    // Group consumers that are not yet mapped by their affinity, since
+    // consumers with the same affinity are interchangeable.
+    const auto bitmap_less = [](
+        hwloc_const_bitmap_t a, hwloc_const_bitmap_t b
+    ) {
+        return hwloc_bitmap_compare(a, b) < 0;
+    };
+    std::map<
+        hwloc_const_bitmap_t, uint_t, decltype(bitmap_less)
+    > aff2group(bitmap_less);
+    std::vector<std::vector<uint_t>> groups;
+    for (uint_t cid = 0; cid < ncon; ++cid) {
+        // Already mapped (potentially by some other mapper).
+        if (qvi_map_fid_mapped(map, cid)) continue;
+        const auto got = aff2group.insert({faffs[cid].cdata(), groups.size()});
+        if (got.second) groups.emplace_back();
+        groups[got.first->second].push_back(cid);
+    }
+    const uint_t ngroups = groups.size();
+    // Calculate the overlap between each group and the resources it touches.
+    resource_index index(tores);
+    std::vector<std::vector<std::pair<uint_t, int64_t>>> overlaps(ngroups);
+    std::vector<int64_t> ovs(nres, 0);
+    int64_t maxov = 0;
+    for (const auto &ag : aff2group) {
+        hwloc_const_bitmap_t aff = ag.first;
+        // Bounded by the indexed bits, since aff may be infinite.
+        const int nbits = index.bit2res.size();
+        for (int bit = hwloc_bitmap_first(aff); bit >= 0 && bit < nbits;
+             bit = hwloc_bitmap_next(aff, bit)) {
+            for (const uint_t rid : index.bit2res[bit]) ovs[rid]++;
+        }
+        for (const uint_t rid : index.infinite) {
+            qvi_hwloc_bitmap inter;
+            hwloc_bitmap_and(inter.data(), aff, tores[rid].cdata());
+            ovs[rid] = std::max(0, hwloc_bitmap_weight(inter.cdata()));
+        }
+        for (uint_t rid = 0; rid < nres; ++rid) {
+            if (ovs[rid] == 0) continue;
+            overlaps[ag.second].push_back({rid, ovs[rid]});
+            maxov = std::max(maxov, ovs[rid]);
+            ovs[rid] = 0;
+        }
+    }
+    // Build the flow network: source -> groups -> resources -> sink, with
+    // edge costs that decrease as overlap increases. Consumers may also reach
+    // any resource with zero overlap through a single spill node, which keeps
+    // the network sparse. Resources hold at most their balanced share.
+    const uint_t src = 0, spill = ngroups + 1;
+    const uint_t res0 = ngroups + 2, sink = res0 + nres;
+    min_cost_flow mcf(sink + 1);
+    std::vector<std::vector<std::pair<uint_t, uint_t>>> gedges(ngroups);
+    std::vector<uint_t> spill_gedges(ngroups), spill_redges(nres);
+    int64_t nunmapped = 0;
+    for (uint_t gid = 0; gid < ngroups; ++gid) {
+        const int64_t gsize = groups[gid].size();
+        nunmapped += gsize;
+        mcf.add_edge(src, gid + 1, gsize, 0);
+        for (const auto &ov : overlaps[gid]) {
+            gedges[gid].push_back({
+                ov.first,
+                mcf.add_edge(gid + 1, res0 + ov.first, gsize, maxov - ov.second)
+            });
+        }
+        spill_gedges[gid] = mcf.add_edge(gid + 1, spill, gsize, maxov);
+    }
+    const int64_t maxcpr = qvi_map_maxiperk(ncon, nres);
+    for (uint_t rid = 0; rid < nres; ++rid) {
+        spill_redges[rid] = mcf.add_edge(spill, res0 + rid, nunmapped, 0);
+        mcf.add_edge(res0 + rid, sink, maxcpr, 0);
+    }
+    if (mcf.solve(src, sink, nunmapped) != nunmapped) {
+        return QV_ERR_INTERNAL;
+    }
+    // Hand out resources to consumers in consumer ID order, first those
+    // reached through overlap, then those reached through the spill node.
+    std::vector<int64_t> spill_left(nres);
+    for (uint_t rid = 0; rid < nres; ++rid) {
+        spill_left[rid] = mcf.flow(spill_redges[rid]);
+    }
+    uint_t spill_rid = 0;
+    for (uint_t gid = 0; gid < ngroups; ++gid) {
+        uint_t i = 0;
+        for (const auto &ge : gedges[gid]) {
+            for (int64_t n = mcf.flow(ge.second); n > 0; --n) {
+                map.insert(groups[gid][i++], ge.first);
+            }
+        }
+        for (int64_t n = mcf.flow(spill_gedges[gid]); n > 0; --n) {
+            while (spill_left[spill_rid] == 0) spill_rid++;
+            spill_left[spill_rid]--;
+            map.insert(groups[gid][i++], spill_rid);
+        }
+    }
+    return QV_SUCCESS;
+}
+
+int
+qvi_map_devices(
+    qvi_map_t &map,
+    const qvi_hwloc_bitmaps &devaffs,
+    const qvi_hwloc_bitmaps &tores,
+    bool balanced
+) {
+    const uint_t ndevs = devaffs.size();
+    const uint_t nres = tores.size();
+    if (ndevs == 0) return QV_SUCCESS;
+    if (nres == 0) return QV_ERR_INVLD_ARG;
+    // When balanced, every resource holds q devices and r of them one more.
+    const uint_t q = ndevs / nres, r = ndevs % nres;
+    uint_t nlarger = 0;
+    std::vector<uint_t> ndevs_at(nres, 0);
+    qvi_hwloc_bitmap inter;
+    for (uint_t devid = 0; devid < ndevs; ++devid) {
+        uint_t best = nres;
+        int best_overlap = 0;
+        for (uint_t rid = 0; rid < nres; ++rid) {
+            if (balanced && ndevs_at[rid] >= (nlarger < r ? q + 1 : q)) {
+                continue;
+            }
+            const int arc = hwloc_bitmap_and(
+                inter.data(), devaffs[devid].cdata(), tores[rid].cdata()
+            );
+            if (qvi_unlikely(arc != 0)) return QV_ERR_HWLOC;
+            const int overlap = std::max(0, hwloc_bitmap_weight(inter.cdata()));
+            if (best == nres || overlap > best_overlap ||
+                (overlap == best_overlap && ndevs_at[rid] < ndevs_at[best])) {
+                best = rid;
+                best_overlap = overlap;
+            }
+        }
+        // Balanced resources always have room for the remaining devices.
+        if (qvi_unlikely(best == nres)) return QV_ERR_INTERNAL;
+        if (ndevs_at[best]++ == q) nlarger++;
+        map.insert(devid, best);
+    }
+    return QV_SUCCESS;
+}
+
+uint64_t
+qvi_map_overlap(
+    const qvi_map_t &map,
+    const qvi_hwloc_bitmaps &faffs,
+    const qvi_hwloc_bitmaps &tores
+) {
+    uint64_t result = 0;
+    qvi_hwloc_bitmap inter;
+    for (uint_t fid = 0; fid < map.extent() && fid < faffs.size(); ++fid) {
+        if (!map.contains(fid)) continue;
+        hwloc_bitmap_and(
+            inter.data(), faffs[fid].cdata(), tores.at(map.at(fid)).cdata()
+        );
+        result += std::max(0, hwloc_bitmap_weight(inter.cdata()));
+    }
+    return result;
+}
+
 const qvi_hwloc_bitmap &
 qvi_map_cpuset_at(
     const qvi_map_t &map,
@@ -309,26 +717,31 @@ qvi_map_cpuset_at(
     return cpusets.at(map.at(fid));
 }
 
-std::vector<uint_t>
+int
 qvi_map_flatten(
-    const qvi_map_t &map
+    const qvi_map_t &map,
+    std::vector<uint_t> &result
 ) {
-    std::vector<uint_t> result(map.size());
-    for (const auto &mi : map) {
-        result[mi.first] = mi.second;
+    result.clear();
+    // Every fid below the map's size must be mapped.
+    if (qvi_unlikely(map.extent() != map.size())) return QV_ERR_INTERNAL;
+
+    result.resize(map.size());
+    for (uint_t fid = 0; fid < map.extent(); ++fid) {
+        result[fid] = map.at(fid);
     }
-    return result;
+    return QV_SUCCESS;
 }
 
-std::vector<int>
+int
 qvi_map_flatten_to_colors(
-    const qvi_map_t &map
+    const qvi_map_t &map,
+    std::vector<int> &result
 ) {
-    std::vector<int> result(map.size());
-    for (const auto &mi : map) {
-        result[mi.first] = (int)mi.second;
-    }
-    return result;
+    std::vector<uint_t> fids;
+    const int rc = qvi_map_flatten(map, fids);
+    result.assign(fids.begin(), fids.end());
+    return rc;
 }
 
 void
@@ -339,8 +752,9 @@ qvi_map_debug_dump(
     qvi_unused(map);
 #else
     qvi_log_debug(" # nfids_mapped={}", qvi_map_nfids_mapped(map));
-    for (const auto &mi : map) {
-        qvi_log_debug(" # fid={} mapped to tid={}", mi.first, mi.second);
+    for (uint_t fid = 0; fid < map.extent(); ++fid) {
+        if (!map.contains(fid)) continue;
+        qvi_log_debug(" # fid={} mapped to tid={}", fid, map.at(fid));
     }
 #endif
 }
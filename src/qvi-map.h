@@ -1,6 +1,6 @@
 /* -*- Mode: C++; c-basic-offset:4; indent-tabs-mode:nil -*- */
 /*
- * Copyright (c) 2022-2024 Triad National Security, LLC
+ * Copyright (c) 2022-2025 Triad National Security, LLC
  *                         All rights reserved.
  *
  * This file is part of the quo-vadis project. See the LICENSE file at the
@@ -17,10 +17,71 @@
 #include "qvi-common.h"
 #include "qvi-hwloc.h"
 
-// TODO(skg)
-//
-/** Maintains a mapping between 'From IDs' to 'To IDs'. */
-using qvi_map_t = std::map<uint_t, uint_t>;
+/**
+ * Maintains a mapping between 'From IDs' to 'To IDs'. From IDs index a flat
+ * array, so lookups and insertions are constant time and cache friendly.
+ */
+struct qvi_map_t {
+private:
+    /** Marks an unmapped From ID. */
+    static constexpr uint_t s_unmapped = UINT_MAX;
+    /** To IDs indexed by From ID. */
+    std::vector<uint_t> m_tids;
+    /** The number of mapped From IDs. */
+    uint_t m_nmapped = 0;
+public:
+    /**
+     * Maps the From ID to the To ID. Returns false
+     * without modifying the map if fid is already mapped.
+     */
+    bool
+    insert(
+        uint_t fid,
+        uint_t tid
+    ) {
+        if (fid >= m_tids.size()) m_tids.resize(fid + 1, s_unmapped);
+        if (m_tids[fid] != s_unmapped) return false;
+        m_tids[fid] = tid;
+        m_nmapped++;
+        return true;
+    }
+    /** Returns whether the From ID is mapped. */
+    bool
+    contains(
+        uint_t fid
+    ) const {
+        return fid < m_tids.size() && m_tids[fid] != s_unmapped;
+    }
+    /** Returns the To ID mapped to the From ID. Throws if it is unmapped. */
+    uint_t
+    at(
+        uint_t fid
+    ) const {
+        if (qvi_unlikely(!contains(fid))) {
+            throw std::out_of_range("qvi_map_t::at");
+        }
+        return m_tids[fid];
+    }
+    /** Returns the number of mapped From IDs. */
+    uint_t
+    size(void) const
+    {
+        return m_nmapped;
+    }
+    /** Returns one past the largest From ID the map has storage for. */
+    uint_t
+    extent(void) const
+    {
+        return m_tids.size();
+    }
+    /** Removes all mappings. */
+    void
+    clear(void)
+    {
+        m_tids.clear();
+        m_nmapped = 0;
+    }
+};
 
 /**
  * Defines a function pointer to a desired mapping function.
@@ -30,10 +91,93 @@ using qvi_map_fn_t = std::function<
 >;
 
 /**
- * Maintains a mapping between resource IDs to a set of
- * consumer IDs that have shared affinity with a given resource.
+ * Maintains a bit matrix recording which consumer IDs have shared affinity
+ * with which resource IDs. Row rid holds one bit per consumer ID, packed into
+ * 64-bit words so rows can be combined and counted a word at a time.
  */
-using qvi_map_shaffinity_t = std::map<uint_t, std::set<uint_t>>;
+struct qvi_map_shaffinity_t {
+private:
+    /** The number of resources (rows). */
+    uint_t m_nres = 0;
+    /** The number of consumers (columns). */
+    uint_t m_ncon = 0;
+    /** The number of words per row. */
+    uint_t m_nwords = 0;
+    /** Row-major bit storage. */
+    std::vector<uint64_t> m_bits;
+public:
+    /** Resizes the matrix and clears all bits. */
+    void
+    reset(
+        uint_t nres,
+        uint_t ncon
+    ) {
+        m_nres = nres;
+        m_ncon = ncon;
+        m_nwords = (ncon + 63) / 64;
+        m_bits.assign(size_t(m_nres) * m_nwords, 0);
+    }
+    /** Returns the number of resources. */
+    uint_t
+    nres(void) const
+    {
+        return m_nres;
+    }
+    /** Returns the number of consumers. */
+    uint_t
+    ncon(void) const
+    {
+        return m_ncon;
+    }
+    /** Returns the number of words per row. */
+    uint_t
+    nwords(void) const
+    {
+        return m_nwords;
+    }
+    /** Returns a pointer to the given resource's row. */
+    uint64_t *
+    row(
+        uint_t rid
+    ) {
+        return m_bits.data() + size_t(rid) * m_nwords;
+    }
+    /** Returns a const pointer to the given resource's row. */
+    const uint64_t *
+    row(
+        uint_t rid
+    ) const {
+        return m_bits.data() + size_t(rid) * m_nwords;
+    }
+    /** Records shared affinity between the resource and consumer. */
+    void
+    set(
+        uint_t rid,
+        uint_t cid
+    ) {
+        row(rid)[cid / 64] |= (uint64_t(1) << (cid % 64));
+    }
+    /** Returns whether the resource and consumer share affinity. */
+    bool
+    test(
+        uint_t rid,
+        uint_t cid
+    ) const {
+        return (row(rid)[cid / 64] >> (cid % 64)) & 1;
+    }
+    /** Returns the number of consumers with affinity to the resource. */
+    uint_t
+    count(
+        uint_t rid
+    ) const {
+        uint_t n = 0;
+        const uint64_t *const r = row(rid);
+        for (uint_t w = 0; w < m_nwords; ++w) {
+            n += __builtin_popcountll(r[w]);
+        }
+        return n;
+    }
+};
 
 /**
  * Returns the largest number that will fit in the space available.
@@ -138,6 +282,45 @@ qvi_map_affinity_preserving(
     const qvi_hwloc_bitmaps &tores
 );
 
+/**
+ * Performs an affinity preserving mapping that maximizes the total overlap
+ * between consumer affinities and the resources they are mapped to, subject to
+ * each resource receiving at most its balanced share of consumers. The
+ * assignment is solved exactly as a minimum-cost flow.
+ */
+int
+qvi_map_affinity_optimal(
+    qvi_map_t &map,
+    const qvi_hwloc_bitmaps &faffs,
+    const qvi_hwloc_bitmaps &tores
+);
+
+/**
+ * Maps devices to resources given their affinities. Each device goes to the
+ * resource it overlaps most, with ties going to the resource holding the
+ * fewest devices. When balanced, resources also receive equal numbers of
+ * devices, give or take one, so a device only goes to a resource it overlaps
+ * less once the ones it overlaps more are full. Devices are placed in order.
+ */
+int
+qvi_map_devices(
+    qvi_map_t &map,
+    const qvi_hwloc_bitmaps &devaffs,
+    const qvi_hwloc_bitmaps &tores,
+    bool balanced
+);
+
+/**
+ * Returns the total overlap (in bits) between the affinities of the mapped
+ * consumers and the resources they are mapped to.
+ */
+uint64_t
+qvi_map_overlap(
+    const qvi_map_t &map,
+    const qvi_hwloc_bitmaps &faffs,
+    const qvi_hwloc_bitmaps &tores
+);
+
 /**
  * Returns a reference to the cpuset mapped to the given From ID.
  */
@@ -148,14 +331,21 @@ qvi_map_cpuset_at(
     uint_t fid
 );
 
-std::vector<uint_t>
+/**
+ * Returns the resource IDs of the mapped fids in fid order. Returns
+ * QV_ERR_INTERNAL if the map has holes.
+ */
+int
 qvi_map_flatten(
-    const qvi_map_t &map
+    const qvi_map_t &map,
+    std::vector<uint_t> &result
 );
 
-std::vector<int>
+/** Like qvi_map_flatten(), but returns the resource IDs as colors. */
+int
 qvi_map_flatten_to_colors(
-    const qvi_map_t &map
+    const qvi_map_t &map,
+    std::vector<int> &result
 );
 
 #endif
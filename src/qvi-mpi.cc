@@ -19,52 +19,213 @@
 #include "qvi-utils.h"
 
 /**
- * Performs a low-noise, high latency node-level barrier across the given
- * communicator.
+ * Performs a node-level barrier across the given communicator, waiting for
+ * completion as qvi_wait_until() does.
  */
 static int
-sleepy_node_barrier(
-    MPI_Comm node_comm
+node_barrier(
+    MPI_Comm node_comm,
+    const qvi_wait_params &params
 ) {
     MPI_Request request;
     int rc = MPI_Ibarrier(node_comm, &request);
     if (qvi_unlikely(rc != MPI_SUCCESS)) return QV_ERR_MPI;
 
-    int done = 0;
-    do {
+    qvi_wait_until([&] {
+        int done = 0;
         rc = MPI_Test(&request, &done, MPI_STATUS_IGNORE);
-        if (qvi_unlikely(rc != MPI_SUCCESS)) return QV_ERR_MPI;
-        std::this_thread::sleep_for(std::chrono::microseconds(50000));
-    } while (!done);
-
+        return done || rc != MPI_SUCCESS;
+    }, params);
+    if (qvi_unlikely(rc != MPI_SUCCESS)) return QV_ERR_MPI;
     return QV_SUCCESS;
 }
 
-std::vector<pid_t>
-qvi_mpi_group::pids(void) const
+/**
+ * Returns the MPI reduction operation corresponding to the provided one.
+ */
+static MPI_Op
+group_op_to_mpi(
+    qvi_group_op_t op
+) {
+    switch (op) {
+        case QVI_GROUP_OP_MIN:
+            return MPI_MIN;
+        case QVI_GROUP_OP_MAX:
+            return MPI_MAX;
+        case QVI_GROUP_OP_SUM:
+            return MPI_SUM;
+        default:
+            return MPI_OP_NULL;
+    }
+}
+
+void
+qvi_mpi_persistent::free(void)
+{
+    // Nothing can be freed once MPI is gone.
+    int finalized = 0;
+    MPI_Finalized(&finalized);
+    if (finalized) return;
+
+    for (MPI_Request *request : {&counts_req, &reduce_req}) {
+        if (*request != MPI_REQUEST_NULL) {
+            MPI_Request_free(request);
+        }
+    }
+}
+
+qvi_mpi_group::qvi_mpi_group(
+    const qvi_mpi_comm &comm,
+    bool node_local
+) : qvcomm(comm)
+  , info(std::make_shared<qvi_mpi_group_info>())
+  , persistent(std::make_shared<qvi_mpi_persistent>())
+  , shmem(std::make_shared<qvi_mpi_shmem>())
 {
     static_assert(
         sizeof(int) == sizeof(pid_t),
         "int and pid_t must have the same size."
     );
 
+    info->node_local = node_local;
     const pid_t mypid = getpid();
-    std::vector<pid_t> allpids(qvcomm.m_size);
-
+    if (qvcomm.m_size == 1) {
+        info->pids = {mypid};
+        return;
+    }
+    info->pids.resize(qvcomm.m_size);
     const int mpirc = MPI_Allgather(
-        &mypid, 1, MPI_INT, allpids.data(),
+        &mypid, 1, MPI_INT, info->pids.data(),
         1, MPI_INT, qvcomm.m_mpi_comm
     );
     if (qvi_unlikely(mpirc != MPI_SUCCESS)) {
         throw qvi_runtime_error(QV_ERR_MPI);
     }
-    return allpids;
+}
+
+qvi_mpi_group::qvi_mpi_group(
+    const qvi_mpi_comm &comm,
+    const std::vector<pid_t> &pids
+) : qvcomm(comm)
+  , info(std::make_shared<qvi_mpi_group_info>())
+  , persistent(std::make_shared<qvi_mpi_persistent>())
+  , shmem(std::make_shared<qvi_mpi_shmem>())
+{
+    info->node_local = true;
+    info->pids = pids;
+}
+
+std::vector<pid_t>
+qvi_mpi_group::pids(void) const
+{
+    if (qvi_unlikely(!info)) return {};
+    return info->pids;
 }
 
 int
 qvi_mpi_group::barrier(void) const
 {
-    return sleepy_node_barrier(qvcomm.m_mpi_comm);
+    return node_barrier(qvcomm.m_mpi_comm, qvi_wait_params_env());
+}
+
+void
+qvi_mpi_shmem::free(void)
+{
+    if (win == MPI_WIN_NULL) return;
+    // Nothing can be freed once MPI is gone.
+    int finalized = 0;
+    MPI_Finalized(&finalized);
+    if (finalized) return;
+
+    MPI_Win_unlock_all(win);
+    MPI_Win_free(&win);
+    base = nullptr;
+}
+
+void
+qvi_mpi_group::free(
+    qvi_mpi_group &group
+) {
+    if (group.shmem) {
+        group.shmem->free();
+    }
+    // Persistent requests go before their communicator.
+    if (group.persistent) {
+        group.persistent->free();
+    }
+    qvi_mpi_comm::free(group.qvcomm);
+}
+
+int
+qvi_mpi_group::m_shmem_begin(
+    byte_t **half
+) const {
+    if (qvi_unlikely(!shmem)) return QV_ERR_INTERNAL;
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "");
+    static constexpr size_t line = alignof(qvi_mpi_shmem_ctl);
+
+    qvi_mpi_shmem &shm = *shmem;
+    // Every member reaches its first operation together, so create the
+    // segment then.
+    if (qvi_unlikely(shm.win == MPI_WIN_NULL)) {
+        const size_t stride = (
+            (sizeof(size_t) + qvi_mpi_shmem::slot_capacity + line - 1) / line
+        ) * line;
+        const size_t half_size = sizeof(qvi_mpi_shmem_ctl)
+                               + stride * qvcomm.m_size;
+        const MPI_Aint seg_size = (qvcomm.m_rank == 0) ?
+            MPI_Aint(2 * half_size) : 0;
+
+        void *base = nullptr;
+        int mpirc = MPI_Win_allocate_shared(
+            seg_size, 1, MPI_INFO_NULL, qvcomm.m_mpi_comm, &base, &shm.win
+        );
+        if (qvi_unlikely(mpirc != MPI_SUCCESS)) return QV_ERR_MPI;
+
+        MPI_Aint qsize = 0;
+        int disp_unit = 0;
+        mpirc = MPI_Win_shared_query(shm.win, 0, &qsize, &disp_unit, &base);
+        if (qvi_unlikely(mpirc != MPI_SUCCESS)) return QV_ERR_MPI;
+        // The segment is accessed through loads and stores in a single
+        // passive epoch.
+        mpirc = MPI_Win_lock_all(MPI_MODE_NOCHECK, shm.win);
+        if (qvi_unlikely(mpirc != MPI_SUCCESS)) return QV_ERR_MPI;
+
+        shm.base = static_cast<byte_t *>(base);
+        shm.half_size = half_size;
+        shm.slot_stride = stride;
+        if (qvcomm.m_rank == 0) {
+            new (shm.base) qvi_mpi_shmem_ctl();
+            new (shm.base + half_size) qvi_mpi_shmem_ctl();
+        }
+        // Make sure the control blocks are initialized before their use.
+        mpirc = MPI_Win_sync(shm.win);
+        if (qvi_unlikely(mpirc != MPI_SUCCESS)) return QV_ERR_MPI;
+        mpirc = MPI_Barrier(qvcomm.m_mpi_comm);
+        if (qvi_unlikely(mpirc != MPI_SUCCESS)) return QV_ERR_MPI;
+        mpirc = MPI_Win_sync(shm.win);
+        if (qvi_unlikely(mpirc != MPI_SUCCESS)) return QV_ERR_MPI;
+    }
+    shm.seq++;
+    shm.uses[shm.seq % 2]++;
+    *half = shm.base + (shm.seq % 2) * shm.half_size;
+    return QV_SUCCESS;
+}
+
+qvi_mpi_shmem_ctl *
+qvi_mpi_group::m_shmem_control(
+    byte_t *half
+) {
+    return reinterpret_cast<qvi_mpi_shmem_ctl *>(half);
+}
+
+byte_t *
+qvi_mpi_group::m_shmem_slot(
+    byte_t *half,
+    int rank
+) const {
+    return half + sizeof(qvi_mpi_shmem_ctl) + size_t(rank) * shmem->slot_stride;
 }
 
 int
@@ -73,52 +234,69 @@ qvi_mpi_group::gather_bbuffs(
     int root,
     std::vector<qvi_bbuff> &rxbuffs
 ) const {
-    const int send_count = (int)txbuff.size();
-    const int group_id = qvcomm.m_rank;
-    const int group_size = qvcomm.m_size;
-
-    int rc = QV_SUCCESS, mpirc = MPI_SUCCESS;
-    std::vector<int> rxcounts, displs;
-    std::vector<byte_t> allbytes;
+    byte_t *half = nullptr;
+    int rc = m_shmem_begin(&half);
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
 
-    if (group_id == root) {
-        rxcounts.resize(group_size);
+    const qvi_mpi_shmem &shm = *shmem;
+    qvi_mpi_shmem_ctl *ctl = m_shmem_control(half);
+    const uint64_t seq = shm.seq;
+    // Wait for the previous user of this half to be done reading our slot.
+    if (seq > 2) {
+        qvi_wait_until([&] {
+            return ctl->ready.load(std::memory_order_acquire) >= seq - 2;
+        });
     }
-    // Figure out now much data are sent by each participant.
-    mpirc = MPI_Gather(
-        &send_count, 1, MPI_INT,
-        rxcounts.data(), 1, MPI_INT,
-        root, qvcomm.m_mpi_comm
-    );
-    if (qvi_unlikely(mpirc != MPI_SUCCESS)) return QV_ERR_MPI;
-    // Root sets up relevant Gatherv data structures.
-    if (group_id == root) {
-        displs.resize(group_size);
-
-        int total_bytes = 0;
-        for (int i = 0; i < group_size; ++i) {
-            displs[i] = total_bytes;
-            total_bytes += rxcounts[i];
-        }
-        allbytes.resize(total_bytes);
+    // Everyone writes directly into their slot, if the data fit.
+    const size_t send_size = txbuff.size();
+    const bool fits = send_size <= qvi_mpi_shmem::slot_capacity;
+    byte_t *slot = m_shmem_slot(half, qvcomm.m_rank);
+    memmove(slot, &send_size, sizeof(send_size));
+    if (fits) {
+        memmove(slot + sizeof(send_size), txbuff.cdata(), send_size);
     }
+    ctl->count.fetch_add(1, std::memory_order_release);
 
-    mpirc = MPI_Gatherv(
-        txbuff.cdata(), send_count, MPI_UINT8_T,
-        allbytes.data(), rxcounts.data(), displs.data(),
-        MPI_UINT8_T, root, qvcomm.m_mpi_comm
-    );
-    if (qvi_unlikely(mpirc != MPI_SUCCESS)) return QV_ERR_MPI;
-    // Root creates new buffers from data gathered from each participant.
-    if (group_id == root) {
-        rxbuffs.resize(group_size);
-        byte_t *bytepos = allbytes.data();
-        for (int i = 0; i < group_size; ++i) {
-            rc = rxbuffs[i].append(bytepos, rxcounts[i]);
-            if (rc != QV_SUCCESS) return rc;
-            bytepos += rxcounts[i];
+    if (qvcomm.m_rank != root) {
+        if (qvi_likely(fits)) return QV_SUCCESS;
+        const int mpirc = MPI_Send(
+            txbuff.cdata(), int(send_size), MPI_UINT8_T,
+            root, qvi_mpi_shmem::tag, qvcomm.m_mpi_comm
+        );
+        if (qvi_unlikely(mpirc != MPI_SUCCESS)) return QV_ERR_MPI;
+        return QV_SUCCESS;
+    }
+    // The root waits for everyone's data and reads them in place.
+    const uint64_t count = shm.uses[seq % 2] * qvcomm.m_size;
+    qvi_wait_until([&] {
+        return ctl->count.load(std::memory_order_acquire) >= count;
+    });
+
+    rxbuffs.clear();
+    rxbuffs.resize(qvcomm.m_size);
+    std::vector<byte_t> bytes;
+    for (int i = 0; i < qvcomm.m_size; ++i) {
+        const byte_t *islot = m_shmem_slot(half, i);
+        size_t size = 0;
+        memmove(&size, islot, sizeof(size));
+        if (size <= qvi_mpi_shmem::slot_capacity) {
+            rc = rxbuffs[i].append(islot + sizeof(size), size);
+        }
+        else if (i == root) {
+            rc = rxbuffs[i].append(txbuff.cdata(), size);
         }
+        else {
+            bytes.resize(size);
+            const int mpirc = MPI_Recv(
+                bytes.data(), int(size), MPI_UINT8_T, i,
+                qvi_mpi_shmem::tag, qvcomm.m_mpi_comm, MPI_STATUS_IGNORE
+            );
+            if (qvi_unlikely(mpirc != MPI_SUCCESS)) return QV_ERR_MPI;
+            rc = rxbuffs[i].append(bytes.data(), size);
+        }
+        if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
     }
+    ctl->ready.store(seq, std::memory_order_release);
     return QV_SUCCESS;
 }
 
@@ -128,49 +306,218 @@ qvi_mpi_group::scatter_bbuffs(
     int root,
     qvi_bbuff &rxbuff
 ) const {
-    const int group_size = qvcomm.m_size;
-    const int group_id = qvcomm.m_rank;
+    byte_t *half = nullptr;
+    int rc = m_shmem_begin(&half);
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
 
-    int mpirc = MPI_SUCCESS, rxcount = 0;
-    int total_bytes = 0;
-    std::vector<int> txcounts, displs;
-    std::vector<byte_t> mybytes, txbytes;
-    // Root sets up relevant Scatterv data structures.
-    if (group_id == root) {
-        txcounts.resize(group_size);
-        displs.resize(group_size);
-
-        for (int i = 0; i < group_size; ++i) {
-            txcounts[i] = (int)txbuffs[i].size();
-            displs[i] = total_bytes;
-            total_bytes += txcounts[i];
+    const qvi_mpi_shmem &shm = *shmem;
+    qvi_mpi_shmem_ctl *ctl = m_shmem_control(half);
+    const uint64_t seq = shm.seq;
+
+    if (qvcomm.m_rank == root) {
+        // Wait for the previous users of this half to be done with it:
+        // everyone that read a slot, and a root that read all of them.
+        const uint64_t count = (shm.uses[seq % 2] - 1) * qvcomm.m_size;
+        qvi_wait_until([&] {
+            if (ctl->count.load(std::memory_order_acquire) < count) {
+                return false;
+            }
+            return seq <= 2 ||
+                ctl->ready.load(std::memory_order_acquire) >= seq - 2;
+        });
+        // The root writes directly into everyone's slot, if the data fit.
+        for (int i = 0; i < qvcomm.m_size; ++i) {
+            byte_t *islot = m_shmem_slot(half, i);
+            const size_t size = txbuffs[i].size();
+            memmove(islot, &size, sizeof(size));
+            if (size <= qvi_mpi_shmem::slot_capacity) {
+                memmove(islot + sizeof(size), txbuffs[i].cdata(), size);
+            }
         }
-        // A flattened buffer containing all the relevant information.
-        txbytes.resize(total_bytes);
-        // Copy buffer data into flattened buffer.
-        byte_t *bytepos = txbytes.data();
-        for (int i = 0; i < group_size; ++i) {
-            memmove(bytepos, txbuffs[i].cdata(), txcounts[i]);
-            bytepos += txcounts[i];
+        ctl->ready.store(seq, std::memory_order_release);
+        // Send the data that did not fit.
+        for (int i = 0; i < qvcomm.m_size; ++i) {
+            const size_t size = txbuffs[i].size();
+            if (i == root || size <= qvi_mpi_shmem::slot_capacity) continue;
+            const int mpirc = MPI_Send(
+                txbuffs[i].cdata(), int(size), MPI_UINT8_T,
+                i, qvi_mpi_shmem::tag, qvcomm.m_mpi_comm
+            );
+            if (qvi_unlikely(mpirc != MPI_SUCCESS)) return QV_ERR_MPI;
+        }
+    }
+    // Everyone waits for the root's data and reads their slot in place.
+    qvi_wait_until([&] {
+        return ctl->ready.load(std::memory_order_acquire) >= seq;
+    });
+    const byte_t *slot = m_shmem_slot(half, qvcomm.m_rank);
+    size_t size = 0;
+    memmove(&size, slot, sizeof(size));
+    if (size <= qvi_mpi_shmem::slot_capacity) {
+        rc = rxbuff.append(slot + sizeof(size), size);
+        ctl->count.fetch_add(1, std::memory_order_release);
+        return rc;
+    }
+    // Done with the slot: the rest comes point-to-point.
+    ctl->count.fetch_add(1, std::memory_order_release);
+    if (qvcomm.m_rank == root) {
+        return rxbuff.append(txbuffs[root].cdata(), size);
+    }
+    std::vector<byte_t> bytes(size);
+    const int mpirc = MPI_Recv(
+        bytes.data(), int(size), MPI_UINT8_T, root,
+        qvi_mpi_shmem::tag, qvcomm.m_mpi_comm, MPI_STATUS_IGNORE
+    );
+    if (qvi_unlikely(mpirc != MPI_SUCCESS)) return QV_ERR_MPI;
+    return rxbuff.append(bytes.data(), size);
+}
+
+int
+qvi_mpi_group::bcast_bbuff(
+    qvi_bbuff &buff,
+    int root
+) const {
+    int count = (int)buff.size();
+    int mpirc = MPI_Bcast(&count, 1, MPI_INT, root, qvcomm.m_mpi_comm);
+    if (qvi_unlikely(mpirc != MPI_SUCCESS)) return QV_ERR_MPI;
+
+    if (qvcomm.m_rank == root) {
+        mpirc = MPI_Bcast(
+            buff.data(), count, MPI_UINT8_T, root, qvcomm.m_mpi_comm
+        );
+        if (qvi_unlikely(mpirc != MPI_SUCCESS)) return QV_ERR_MPI;
+        return QV_SUCCESS;
+    }
+
+    std::vector<byte_t> bytes(count);
+    mpirc = MPI_Bcast(
+        bytes.data(), count, MPI_UINT8_T, root, qvcomm.m_mpi_comm
+    );
+    if (qvi_unlikely(mpirc != MPI_SUCCESS)) return QV_ERR_MPI;
+
+    buff = qvi_bbuff();
+    return buff.append(bytes.data(), count);
+}
+
+int
+qvi_mpi_group::m_allgather_counts(
+    int count,
+    std::vector<int> &counts
+) const {
+#if QVI_MPI_PERSISTENT_COLLS
+    // Every allgather starts with this exchange, so make it persistent.
+    if (persistent) {
+        qvi_mpi_persistent &pcoll = *persistent;
+        int mpirc = MPI_SUCCESS;
+        if (pcoll.counts_req == MPI_REQUEST_NULL) {
+            pcoll.counts.resize(qvcomm.m_size);
+            mpirc = MPI_Allgather_init(
+                &pcoll.count, 1, MPI_INT, pcoll.counts.data(), 1, MPI_INT,
+                qvcomm.m_mpi_comm, MPI_INFO_NULL, &pcoll.counts_req
+            );
+            if (qvi_unlikely(mpirc != MPI_SUCCESS)) return QV_ERR_MPI;
         }
+        pcoll.count = count;
+        mpirc = MPI_Start(&pcoll.counts_req);
+        if (qvi_unlikely(mpirc != MPI_SUCCESS)) return QV_ERR_MPI;
+        mpirc = MPI_Wait(&pcoll.counts_req, MPI_STATUS_IGNORE);
+        if (qvi_unlikely(mpirc != MPI_SUCCESS)) return QV_ERR_MPI;
+        counts = pcoll.counts;
+        return QV_SUCCESS;
     }
-    // Scatter buffer sizes.
-    mpirc = MPI_Scatter(
-        txcounts.data(), 1, MPI_INT,
-        &rxcount, 1, MPI_INT,
-        root, qvcomm.m_mpi_comm
+#endif
+    counts.resize(qvcomm.m_size);
+    const int mpirc = MPI_Allgather(
+        &count, 1, MPI_INT, counts.data(), 1, MPI_INT, qvcomm.m_mpi_comm
     );
     if (qvi_unlikely(mpirc != MPI_SUCCESS)) return QV_ERR_MPI;
-    // Everyone allocates a buffer for their data.
-    mybytes.resize(rxcount);
+    return QV_SUCCESS;
+}
+
+int
+qvi_mpi_group::allgather_bbuffs(
+    const qvi_bbuff &txbuff,
+    std::vector<qvi_bbuff> &rxbuffs
+) const {
+    const int send_count = (int)txbuff.size();
+    const int group_size = qvcomm.m_size;
+    // Figure out now much data are sent by each participant.
+    std::vector<int> rxcounts;
+    int rc = m_allgather_counts(send_count, rxcounts);
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
 
-    mpirc = MPI_Scatterv(
-        txbytes.data(), txcounts.data(), displs.data(), MPI_UINT8_T,
-        mybytes.data(), rxcount, MPI_UINT8_T, root, qvcomm.m_mpi_comm
+    std::vector<int> displs(group_size);
+    int total_bytes = 0;
+    for (int i = 0; i < group_size; ++i) {
+        displs[i] = total_bytes;
+        total_bytes += rxcounts[i];
+    }
+    std::vector<byte_t> allbytes(total_bytes);
+
+    const int mpirc = MPI_Allgatherv(
+        txbuff.cdata(), send_count, MPI_UINT8_T,
+        allbytes.data(), rxcounts.data(), displs.data(),
+        MPI_UINT8_T, qvcomm.m_mpi_comm
     );
     if (qvi_unlikely(mpirc != MPI_SUCCESS)) return QV_ERR_MPI;
 
-    return rxbuff.append(mybytes.data(), rxcount);
+    rxbuffs.clear();
+    rxbuffs.resize(group_size);
+    byte_t *bytepos = allbytes.data();
+    for (int i = 0; i < group_size; ++i) {
+        rc = rxbuffs[i].append(bytepos, rxcounts[i]);
+        if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+        bytepos += rxcounts[i];
+    }
+    return QV_SUCCESS;
+}
+
+int
+qvi_mpi_group::allreduce(
+    const std::vector<int64_t> &send,
+    qvi_group_op_t op,
+    std::vector<int64_t> &recv
+) const {
+    const MPI_Op mpi_op = group_op_to_mpi(op);
+    if (qvi_unlikely(mpi_op == MPI_OP_NULL)) return QV_ERR_INVLD_ARG;
+
+    const int count = (int)send.size();
+    int mpirc = MPI_SUCCESS;
+#if QVI_MPI_PERSISTENT_COLLS
+    // Reuse the persistent reduction while its shape stays the same.
+    if (persistent) {
+        qvi_mpi_persistent &pcoll = *persistent;
+        if (pcoll.reduce_req == MPI_REQUEST_NULL || pcoll.reduce_op != op ||
+            pcoll.reduce_send.size() != send.size()) {
+            if (pcoll.reduce_req != MPI_REQUEST_NULL) {
+                MPI_Request_free(&pcoll.reduce_req);
+            }
+            pcoll.reduce_op = op;
+            pcoll.reduce_send.resize(count);
+            pcoll.reduce_recv.resize(count);
+            mpirc = MPI_Allreduce_init(
+                pcoll.reduce_send.data(), pcoll.reduce_recv.data(), count,
+                MPI_INT64_T, mpi_op, qvcomm.m_mpi_comm, MPI_INFO_NULL,
+                &pcoll.reduce_req
+            );
+            if (qvi_unlikely(mpirc != MPI_SUCCESS)) return QV_ERR_MPI;
+        }
+        std::copy(send.begin(), send.end(), pcoll.reduce_send.begin());
+        mpirc = MPI_Start(&pcoll.reduce_req);
+        if (qvi_unlikely(mpirc != MPI_SUCCESS)) return QV_ERR_MPI;
+        mpirc = MPI_Wait(&pcoll.reduce_req, MPI_STATUS_IGNORE);
+        if (qvi_unlikely(mpirc != MPI_SUCCESS)) return QV_ERR_MPI;
+        recv = pcoll.reduce_recv;
+        return QV_SUCCESS;
+    }
+#endif
+    recv.resize(count);
+    mpirc = MPI_Allreduce(
+        send.data(), recv.data(), count,
+        MPI_INT64_T, mpi_op, qvcomm.m_mpi_comm
+    );
+    if (qvi_unlikely(mpirc != MPI_SUCCESS)) return QV_ERR_MPI;
+    return QV_SUCCESS;
 }
 
 int
@@ -203,14 +550,45 @@ mpi_comm_to_new_node_comm(
 }
 
 /**
- * Initializes a QV group from an MPI communicator.
+ * Creates a communicator among the provided members of comm, in the order
+ * given. Only those members take part.
  */
 static int
-group_init_from_mpi_comm(
+comm_create_from_members(
     MPI_Comm comm,
+    const std::vector<int> &members,
+    MPI_Comm *newcomm
+) {
+    // Tag of the communicator creation, unique among qvi_mpi's.
+    static constexpr int tag = 0x5154;
+
+    *newcomm = MPI_COMM_NULL;
+    MPI_Group group = MPI_GROUP_NULL, subgroup = MPI_GROUP_NULL;
+    int mpirc = MPI_Comm_group(comm, &group);
+    if (qvi_unlikely(mpirc != MPI_SUCCESS)) return QV_ERR_MPI;
+
+    mpirc = MPI_Group_incl(group, members.size(), members.data(), &subgroup);
+    MPI_Group_free(&group);
+    if (qvi_unlikely(mpirc != MPI_SUCCESS)) return QV_ERR_MPI;
+
+    mpirc = MPI_Comm_create_group(comm, subgroup, tag, newcomm);
+    MPI_Group_free(&subgroup);
+    if (qvi_unlikely(mpirc != MPI_SUCCESS)) {
+        *newcomm = MPI_COMM_NULL;
+        return QV_ERR_MPI;
+    }
+    return QV_SUCCESS;
+}
+
+/**
+ * Initializes a QV group from a node communicator.
+ */
+static int
+group_init_from_node_comm(
+    MPI_Comm node_comm,
     qvi_mpi_group &group
 ) {
-    group.qvcomm = qvi_mpi_comm(comm, false);
+    group = qvi_mpi_group(qvi_mpi_comm(node_comm, false), true);
     return QV_SUCCESS;
 }
 
@@ -237,13 +615,21 @@ qvi_mpi::m_create_intrinsic_comms(
 int
 qvi_mpi::m_create_intrinsic_groups(void)
 {
-    int rc = add_group(qvi_mpi_group(m_self_comm), QVI_MPI_GROUP_SELF);
+    const qvi_mpi_group self_group(m_self_comm, true);
+    int rc = add_group(self_group, QVI_MPI_GROUP_SELF);
     if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
 
-    rc = add_group(qvi_mpi_group(m_node_comm), QVI_MPI_GROUP_NODE);
+    const qvi_mpi_group node_group(m_node_comm, true);
+    rc = add_group(node_group, QVI_MPI_GROUP_NODE);
     if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+    // Make the node-local groups available for reuse. Self goes first, so it
+    // wins if this process is alone on its node.
+    m_group_cache.insert({self_group.info->pids, QVI_MPI_GROUP_SELF});
+    m_group_cache.insert({node_group.info->pids, QVI_MPI_GROUP_NODE});
 
-    return add_group(qvi_mpi_group(m_world_comm), QVI_MPI_GROUP_WORLD);
+    return add_group(
+        qvi_mpi_group(m_world_comm, false), QVI_MPI_GROUP_WORLD
+    );
 }
 
 int
@@ -263,7 +649,7 @@ qvi_mpi::m_create_admin_comms(void)
     if (node_rep_comm != MPI_COMM_NULL) {
         m_node_rep_comm = qvi_mpi_comm(node_rep_comm, false);
         // Add the comm to the group.
-        return add_group(m_node_rep_comm);
+        return add_group(qvi_mpi_group(m_node_rep_comm, false));
     }
     return QV_SUCCESS;
 }
@@ -346,9 +732,17 @@ qvi_mpi::m_start_daemons(void)
         // Else, start up the daemon using our default port number.
         rc = qvi_start_quo_vadisd(57550);
     } while (false);
-    // See if any errors happened above, but all barrier to avoid hangs.
+    // See if any errors happened above, but all barrier to avoid hangs. Use
+    // a low-noise barrier because starting a daemon takes a while, and the
+    // waiting processes should not compete with it for CPU time.
     if (qvi_unlikely(rc != QV_SUCCESS)) ret = rc;
-    rc = sleepy_node_barrier(m_node_comm.m_mpi_comm);
+    qvi_wait_params low_noise;
+    low_noise.low_noise = true;
+    low_noise.spin = std::chrono::microseconds(0);
+    low_noise.max_sleep = std::chrono::microseconds(
+        qvi_wait_params::low_noise_sleep_us
+    );
+    rc = node_barrier(m_node_comm.m_mpi_comm, low_noise);
     if (qvi_unlikely(rc != QV_SUCCESS)) ret = rc;
     return ret;
 }
@@ -391,8 +785,14 @@ qvi_mpi::qvi_mpi(
 
 qvi_mpi::~qvi_mpi(void)
 {
-    for (auto &i : m_group_tab) {
-        qvi_mpi_comm::free(i.second.qvcomm);
+    // Freeing groups is collective, so do it in the same order everywhere.
+    std::vector<qvi_group_id_t> gids;
+    for (const auto &i : m_group_tab) {
+        gids.push_back(i.first);
+    }
+    std::sort(gids.begin(), gids.end());
+    for (const auto gid : gids) {
+        qvi_mpi_group::free(m_group_tab.at(gid).group);
     }
 }
 
@@ -407,10 +807,99 @@ qvi_mpi::add_group(
         const int rc = qvi_group::next_id(&gid);
         if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
     }
-    m_group_tab.insert({gid, group});
+    if (qvi_unlikely(!group.info)) return QV_ERR_INTERNAL;
+    group.info->id = gid;
+    m_group_tab.insert({gid, {group, 1}});
+    return QV_SUCCESS;
+}
+
+void
+qvi_mpi::release_group(
+    const qvi_mpi_group &group
+) {
+    auto got = m_group_tab.find(group.id());
+    if (got == m_group_tab.end()) return;
+
+    qvi_mpi_group_entry &entry = got->second;
+    assert(entry.refc > 0);
+    entry.refc--;
+    // The context holds a reference to each intrinsic group.
+    const int64_t floor = (got->first <= QVI_MPI_GROUP_WORLD) ? 1 : 0;
+    if (entry.refc > floor) return;
+    // Every member of the group releases its last reference here, so this is
+    // where they can agree on which of its children to free. Unreferenced
+    // groups are otherwise kept for reuse by identical splits.
+    const int rc = m_free_unreferenced_children(got->first);
+    if (qvi_unlikely(rc != QV_SUCCESS)) {
+        qvi_log_warn("Freeing unreferenced groups failed (rc={})", rc);
+    }
+}
+
+void
+qvi_mpi::m_add_child(
+    qvi_group_id_t parent,
+    uint64_t split_index,
+    const qvi_mpi_group &child
+) {
+    // Intrinsic groups belong to the context.
+    if (child.id() <= QVI_MPI_GROUP_WORLD) return;
+
+    qvi_mpi_group_entry &entry = m_group_tab.at(child.id());
+    entry.parent = parent;
+    entry.split_index = split_index;
+}
+
+int
+qvi_mpi::m_free_unreferenced_children(
+    qvi_group_id_t id
+) {
+    qvi_mpi_group_entry &entry = m_group_tab.at(id);
+    // Every member of the group took part in the same splits, so all of them
+    // return here together.
+    const uint64_t first = entry.first_kept_split;
+    const uint64_t nsplits = entry.nsplits;
+    if (first == nsplits) return QV_SUCCESS;
+    // A child is freed if none of its members reference it. Each member has
+    // at most one child per split, so index votes by split: 0 keeps a child.
+    std::vector<int64_t> unused(nsplits - first, 1);
+    std::map<uint64_t, qvi_group_id_t> children;
+    for (const auto &i : m_group_tab) {
+        const qvi_mpi_group_entry &child = i.second;
+        if (child.parent != id || child.split_index < first) continue;
+        children.insert({child.split_index, i.first});
+        if (child.refc > 0) unused[child.split_index - first] = 0;
+    }
+    std::vector<int64_t> agreed;
+    const int rc = entry.group.allreduce(unused, QVI_GROUP_OP_MIN, agreed);
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+    // Later sweeps only need to start at the oldest child that is kept.
+    uint64_t kept = first;
+    while (kept < nsplits && agreed[kept - first] == 1) kept++;
+    entry.first_kept_split = kept;
+    // Freeing is collective over each child, whose members all free their
+    // children in split order.
+    for (const auto &child : children) {
+        if (agreed[child.first - first] == 1) m_free_group(child.second);
+    }
     return QV_SUCCESS;
 }
 
+void
+qvi_mpi::m_free_group(
+    qvi_group_id_t id
+) {
+    auto got = m_group_tab.find(id);
+    if (got == m_group_tab.end()) return;
+
+    qvi_mpi_group &group = got->second.group;
+    const auto cached = m_group_cache.find(group.info->pids);
+    if (cached != m_group_cache.end() && cached->second == id) {
+        m_group_cache.erase(cached);
+    }
+    qvi_mpi_group::free(group);
+    m_group_tab.erase(got);
+}
+
 int
 qvi_mpi::group_from_group_id(
     qvi_group_id_t id,
@@ -421,7 +910,30 @@ qvi_mpi::group_from_group_id(
         group = {};
         return QV_ERR_NOT_FOUND;
     }
-    group = got->second;
+    got->second.refc++;
+    group = got->second.group;
+    return QV_SUCCESS;
+}
+
+int
+qvi_mpi::m_group_from_cache(
+    const std::vector<pid_t> &pids,
+    qvi_mpi_group &group
+) {
+    const auto got = m_group_cache.find(pids);
+    if (got == m_group_cache.end()) return QV_ERR_NOT_FOUND;
+    return group_from_group_id(got->second, group);
+}
+
+int
+qvi_mpi::m_add_cached_group(
+    const qvi_mpi_group &group
+) {
+    const int rc = add_group(group);
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+    // Replace any older group with the same members, so
+    // that all members agree on which one to reuse.
+    m_group_cache[group.info->pids] = group.id();
     return QV_SUCCESS;
 }
 
@@ -434,17 +946,70 @@ qvi_mpi::group_from_split(
 ) {
     int rc = QV_SUCCESS;
     MPI_Comm split_comm = MPI_COMM_NULL;
+    const MPI_Comm parent_comm = parent.qvcomm.m_mpi_comm;
+    const bool node_local = parent.info && parent.info->node_local;
+    // Every member of the parent takes part in every split of it, so
+    // split indices agree across members.
+    auto pentry = m_group_tab.find(parent.id());
+    if (qvi_unlikely(pentry == m_group_tab.end())) return QV_ERR_INTERNAL;
+    const qvi_group_id_t parent_id = pentry->first;
+    const uint64_t split_index = pentry->second.nsplits++;
 
     do {
+        // The members of a node-local group's children, and their PIDs, are
+        // known once the colors and keys are, so either reuse a group with
+        // the same members or create one among them only.
+        if (node_local) {
+            const int mine[2] = {color, key};
+            std::vector<int> colorkeys(2 * parent.size());
+            int mpirc = MPI_Allgather(
+                mine, 2, MPI_INT, colorkeys.data(), 2, MPI_INT, parent_comm
+            );
+            if (qvi_unlikely(mpirc != MPI_SUCCESS)) {
+                rc = QV_ERR_MPI;
+                break;
+            }
+            // Order the members like MPI_Comm_split: by key, then by rank.
+            std::vector<int> members;
+            for (int i = 0; i < parent.size(); ++i) {
+                if (colorkeys[2 * i] == color) members.push_back(i);
+            }
+            std::stable_sort(
+                members.begin(), members.end(), [&](int a, int b) {
+                    return colorkeys[2 * a + 1] < colorkeys[2 * b + 1];
+                }
+            );
+            std::vector<pid_t> pids;
+            for (const int member : members) {
+                pids.push_back(parent.info->pids[member]);
+            }
+            // Groups are cached by all of their members when created and
+            // are only freed by all of them together, so the child's members
+            // agree on whether they have one without communicating.
+            rc = m_group_from_cache(pids, child);
+            if (rc != QV_ERR_NOT_FOUND) break;
+            // Other children may have been found, so only involve ours.
+            rc = comm_create_from_members(parent_comm, members, &split_comm);
+            if (qvi_unlikely(rc != QV_SUCCESS)) break;
+            child = qvi_mpi_group(qvi_mpi_comm(split_comm, false), pids);
+            split_comm = MPI_COMM_NULL;
+
+            rc = m_add_cached_group(child);
+            if (qvi_unlikely(rc != QV_SUCCESS)) break;
+            m_add_child(parent_id, split_index, child);
+            break;
+        }
+
         const int mpirc = MPI_Comm_split(
-            parent.qvcomm.m_mpi_comm, color, key, &split_comm
+            parent_comm, color, key, &split_comm
         );
         if (qvi_unlikely(mpirc != MPI_SUCCESS)) {
             rc = QV_ERR_MPI;
             break;
         }
-
         rc = group_from_mpi_comm(split_comm, child);
+        if (qvi_unlikely(rc != QV_SUCCESS)) break;
+        m_add_child(parent_id, split_index, child);
     } while (false);
 
     if (qvi_unlikely(rc != QV_SUCCESS)) {
@@ -466,13 +1031,26 @@ qvi_mpi::group_from_mpi_comm(
     MPI_Comm node_comm = MPI_COMM_NULL;
 
     do {
+        int size = 0;
+        const int mpirc = MPI_Comm_size(comm, &size);
+        if (qvi_unlikely(mpirc != MPI_SUCCESS)) {
+            rc = QV_ERR_MPI;
+            break;
+        }
+        // Reuse the self group for single-member communicators.
+        if (size == 1) {
+            rc = m_group_from_cache({getpid()}, group);
+            if (rc != QV_ERR_NOT_FOUND) break;
+            rc = QV_SUCCESS;
+        }
+
         rc = mpi_comm_to_new_node_comm(comm, &node_comm);
         if (qvi_unlikely(rc != QV_SUCCESS)) break;
 
-        rc = group_init_from_mpi_comm(node_comm, group);
+        rc = group_init_from_node_comm(node_comm, group);
         if (qvi_unlikely(rc != QV_SUCCESS)) break;
 
-        rc = add_group(group);
+        rc = m_add_cached_group(group);
     } while (false);
 
     if (rc != QV_SUCCESS) {
@@ -34,6 +34,108 @@ static constexpr qvi_group_id_t QVI_MPI_GROUP_SELF = 1;
 static constexpr qvi_group_id_t QVI_MPI_GROUP_NODE = 2;
 static constexpr qvi_group_id_t QVI_MPI_GROUP_WORLD = 3;
 
+/**
+ * Whether to use persistent collectives, which arrived in MPI-4. They are
+ * opt-in through the QV_MPI_PERSISTENT_COLLS build option.
+ */
+#if defined(QV_MPI_PERSISTENT_COLLS) && MPI_VERSION >= 4
+#define QVI_MPI_PERSISTENT_COLLS 1
+#else
+#define QVI_MPI_PERSISTENT_COLLS 0
+#endif
+
+/**
+ * Persistent collective requests for operations that a group repeats with the
+ * same shape, like the size exchange that precedes every allgather. They are
+ * only created when QVI_MPI_PERSISTENT_COLLS is set.
+ */
+struct qvi_mpi_persistent {
+    /** Allgathers count into counts. */
+    MPI_Request counts_req = MPI_REQUEST_NULL;
+    /** Send buffer of counts_req. */
+    int count = 0;
+    /** Receive buffer of counts_req. */
+    std::vector<int> counts;
+    /** Allreduces reduce_send into reduce_recv using reduce_op. */
+    MPI_Request reduce_req = MPI_REQUEST_NULL;
+    /** The reduction operation of reduce_req. */
+    qvi_group_op_t reduce_op = QVI_GROUP_OP_MIN;
+    /** Send buffer of reduce_req. */
+    std::vector<int64_t> reduce_send;
+    /** Receive buffer of reduce_req. */
+    std::vector<int64_t> reduce_recv;
+    /** Constructor. */
+    qvi_mpi_persistent(void) = default;
+    /** Destructor. */
+    ~qvi_mpi_persistent(void)
+    {
+        free();
+    }
+    /** Frees the requests. Must be called before the communicator is freed. */
+    void
+    free(void);
+};
+
+/**
+ * Control block at the start of each half of a shared-memory segment.
+ */
+struct qvi_mpi_shmem_ctl {
+    /**
+     * Sequence number of the last operation whose root is done with the
+     * half: a scatter's root has published its data, a gather's root has
+     * read everyone's.
+     */
+    alignas(64) std::atomic<uint64_t> ready = {0};
+    /**
+     * Number of times members were done with the half: after writing their
+     * slot in a gather, or reading it in a scatter. Never reset.
+     */
+    alignas(64) std::atomic<uint64_t> count = {0};
+};
+
+/**
+ * A node-local shared-memory segment through which group members exchange
+ * data. Consecutive operations alternate between the segment's two halves,
+ * so members only wait on those they exchange data with. Each half holds a
+ * control block followed by one slot per member, each a size header followed
+ * by up to slot_capacity bytes. Larger data are sent point-to-point instead.
+ * The first member allocates the whole segment.
+ */
+struct qvi_mpi_shmem {
+    /** Slot capacity in bytes. */
+    static constexpr size_t slot_capacity = 8192;
+    /** Tag of point-to-point messages carrying data too large for a slot. */
+    static constexpr int tag = 0x5153;
+    /** The window exposing the segment. */
+    MPI_Win win = MPI_WIN_NULL;
+    /** Base address of the segment. */
+    byte_t *base = nullptr;
+    /** Size of each half in bytes. */
+    size_t half_size = 0;
+    /** Distance between consecutive slots in bytes. */
+    size_t slot_stride = 0;
+    /** Sequence number of the current operation. Advances in lockstep. */
+    uint64_t seq = 0;
+    /** Number of operations that used each half. Advances in lockstep. */
+    std::array<uint64_t, 2> uses = {};
+    /** Frees the window. This is collective over the window's group. */
+    void
+    free(void);
+};
+
+/**
+ * Group metadata that stays the same over the group's
+ * lifetime, so it is computed once at group creation.
+ */
+struct qvi_mpi_group_info {
+    /** The group's ID, assigned when it is added to the group table. */
+    qvi_group_id_t id = QVI_MPI_GROUP_NULL;
+    /** PIDs of the group members in rank order. */
+    std::vector<pid_t> pids;
+    /** Whether all group members share a node. */
+    bool node_local = false;
+};
+
 struct qvi_mpi_comm {
     friend qvi_mpi_group;
     friend qvi_mpi;
@@ -87,14 +189,67 @@ public:
 };
 
 struct qvi_mpi_group {
+private:
+    /** Allgathers one count from each member. */
+    int
+    m_allgather_counts(
+        int count,
+        std::vector<int> &counts
+    ) const;
+    /**
+     * Starts an operation on the shared-memory segment, creating it if
+     * needed. Returns the half of the segment the operation uses.
+     */
+    int
+    m_shmem_begin(
+        byte_t **half
+    ) const;
+    /** Returns the control block of the provided half. */
+    static qvi_mpi_shmem_ctl *
+    m_shmem_control(
+        byte_t *half
+    );
+    /** Returns the provided member's slot in the provided half. */
+    byte_t *
+    m_shmem_slot(
+        byte_t *half,
+        int rank
+    ) const;
+public:
     /** The group's communicator info. */
     qvi_mpi_comm qvcomm = {};
+    /** Group metadata, shared by all copies of the group. */
+    std::shared_ptr<qvi_mpi_group_info> info;
+    /** Persistent collectives, shared by all copies of the group. */
+    std::shared_ptr<qvi_mpi_persistent> persistent;
+    /** Shared-memory segment, shared by all copies of the group. */
+    std::shared_ptr<qvi_mpi_shmem> shmem;
     /** Constructor. */
     qvi_mpi_group(void) = default;
-    /** Constructor. */
+    /**
+     * Constructor. Collective over the provided communicator,
+     * since it gathers the members' PIDs.
+     */
     qvi_mpi_group(
-        const qvi_mpi_comm &comm
-    ) : qvcomm(comm) { }
+        const qvi_mpi_comm &comm,
+        bool node_local
+    );
+    /**
+     * Constructor for a node-local group whose members' PIDs are already
+     * known. Not collective.
+     */
+    qvi_mpi_group(
+        const qvi_mpi_comm &comm,
+        const std::vector<pid_t> &pids
+    );
+    /**
+     * Frees the resources associated with the provided instance,
+     * including its communicator. This is collective.
+     */
+    static void
+    free(
+        qvi_mpi_group &group
+    );
     /** Returns the size of the group. */
     int
     size(void) const
@@ -107,26 +262,54 @@ struct qvi_mpi_group {
     {
         return qvcomm.m_rank;
     }
+    /** Returns the group's ID. */
+    qvi_group_id_t
+    id(void) const
+    {
+        return info ? info->id : QVI_MPI_GROUP_NULL;
+    }
     /** Returns the PIDs of all the group members. */
     std::vector<pid_t>
     pids(void) const;
-    /** Performs a low-noise, high-latency barrier. */
+    /**
+     * Performs a barrier that spins briefly, then backs off exponentially.
+     * See qvi_wait_params_env().
+     */
     int
     barrier(void) const;
-    /** Gathers bbuffs. */
+    /** Gathers bbuffs through the group's shared-memory segment. */
     int
     gather_bbuffs(
         const qvi_bbuff &txbuff,
         int root,
         std::vector<qvi_bbuff> &rxbuffs
     ) const;
-    /** Scatters bbuffs. */
+    /** Scatters bbuffs through the group's shared-memory segment. */
     int
     scatter_bbuffs(
         const std::vector<qvi_bbuff> &txbuffs,
         int root,
         qvi_bbuff &rxbuff
     ) const;
+    /** Broadcasts a bbuff. */
+    int
+    bcast_bbuff(
+        qvi_bbuff &buff,
+        int root
+    ) const;
+    /** Allgathers bbuffs. */
+    int
+    allgather_bbuffs(
+        const qvi_bbuff &txbuff,
+        std::vector<qvi_bbuff> &rxbuffs
+    ) const;
+    /** Element-wise reduces values across all members. */
+    int
+    allreduce(
+        const std::vector<int64_t> &send,
+        qvi_group_op_t op,
+        std::vector<int64_t> &recv
+    ) const;
     /** Duplicates the underlying group communicator and returns it. */
     int
     comm_dup(
@@ -134,11 +317,44 @@ struct qvi_mpi_group {
     ) const;
 };
 
+/**
+ * A group table entry.
+ */
+struct qvi_mpi_group_entry {
+    /** The group. */
+    qvi_mpi_group group;
+    /**
+     * Number of references to the group. Unreferenced groups are kept
+     * for reuse until their parent's last reference is released.
+     */
+    int64_t refc = 1;
+    /** ID of the group this group was split from, if any. */
+    qvi_group_id_t parent = QVI_MPI_GROUP_NULL;
+    /** Index of the split of the parent that created this group. */
+    uint64_t split_index = 0;
+    /** Number of splits of this group so far. */
+    uint64_t nsplits = 0;
+    /** Index of the oldest split whose child may still be kept. */
+    uint64_t first_kept_split = 0;
+};
+
 using qvi_mpi_group_tab = std::unordered_map<
-    qvi_group_id_t, qvi_mpi_group
+    qvi_group_id_t, qvi_mpi_group_entry
+>;
+
+/**
+ * Maps the member PIDs, in rank order, of node-local groups to their ID.
+ */
+using qvi_mpi_group_cache = std::map<
+    std::vector<pid_t>, qvi_group_id_t
 >;
 
-struct qvi_mpi {
+/**
+ * MPI context. It is reference counted, so that groups created from it can
+ * outlive the group that created it. Destroying it frees every group it
+ * still holds, which is collective.
+ */
+struct qvi_mpi : qvi_refc {
 private:
     /** Node representative communicator. Only valid for elected processes. */
     qvi_mpi_comm m_node_rep_comm;
@@ -150,6 +366,8 @@ private:
     qvi_mpi_comm m_world_comm;
     /** Group table (ID to internal structure mapping). */
     qvi_mpi_group_tab m_group_tab;
+    /** Node-local groups that can be reused by identical splits. */
+    qvi_mpi_group_cache m_group_cache;
     /** Creates intrinsic communicators. */
     int
     m_create_intrinsic_comms(
@@ -170,6 +388,43 @@ private:
     /** */
     int
     m_start_daemons(void);
+    /**
+     * Returns a new reference to the cached group with the provided members,
+     * or QV_ERR_NOT_FOUND if there is none. Not collective.
+     */
+    int
+    m_group_from_cache(
+        const std::vector<pid_t> &pids,
+        qvi_mpi_group &group
+    );
+    /**
+     * Adds a new node-local group to the group table and the cache,
+     * replacing any cached group with the same members.
+     */
+    int
+    m_add_cached_group(
+        const qvi_mpi_group &group
+    );
+    /** Records that child was created by the provided split of parent. */
+    void
+    m_add_child(
+        qvi_group_id_t parent,
+        uint64_t split_index,
+        const qvi_mpi_group &child
+    );
+    /**
+     * Frees the children of the provided group that none of their members
+     * reference. Collective over the group.
+     */
+    int
+    m_free_unreferenced_children(
+        qvi_group_id_t id
+    );
+    /** Frees the provided group and drops it from the table and the cache. */
+    void
+    m_free_group(
+        qvi_group_id_t id
+    );
 public:
     /** Constructor. */
     qvi_mpi(void) = delete;
@@ -178,14 +433,32 @@ public:
         MPI_Comm comm
     );
     /** Destructor. */
-    ~qvi_mpi(void);
-    /** Adds a new group to the group table. */
+    virtual ~qvi_mpi(void);
+    /**
+     * Adds a new group to the group table. The caller
+     * owns the group's first reference.
+     */
     int
     add_group(
         const qvi_mpi_group &group,
         qvi_group_id_t given_id = QVI_MPI_GROUP_NULL
     );
-    /** */
+    /**
+     * Releases a reference to the provided group. Groups without references
+     * are kept for reuse by identical splits. Releasing the last reference to
+     * a group that was split is collective over the group: it frees the
+     * children that none of their members reference anymore, along with their
+     * communicators. Children still referenced are freed when the context is
+     * destroyed.
+     */
+    void
+    release_group(
+        const qvi_mpi_group &group
+    );
+    /**
+     * The group_from_* functions return a new reference
+     * to the group, which must be released by the caller.
+     */
     int
     group_from_group_id(
         qvi_group_id_t id,
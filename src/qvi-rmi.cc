@@ -348,8 +348,8 @@ qvi_rmi_client::connect(
         return QV_RES_UNAVAILABLE;
     }
     // Now initiate the client/server exchange.
-    std::string hwtopo_path;
-    int rc = m_hello(hwtopo_path);
+    std::string hwtopo_path, hwtopo_synthetic;
+    int rc = m_hello(hwtopo_path, hwtopo_synthetic);
     if (qvi_unlikely(rc != QV_SUCCESS)) {
         return QV_RES_UNAVAILABLE;
     }
@@ -361,11 +361,18 @@ qvi_rmi_client::connect(
     m_config.portno = portno;
     m_config.url = url;
     m_config.hwtopo_path = hwtopo_path;
-    // Now we can initialize and load our topology.
-    rc = m_hwloc.topology_init(m_config.hwtopo_path);
+    m_config.hwtopo_synthetic = hwtopo_synthetic;
+    // Now we can initialize and load our topology. A synthetic server
+    // topology is rebuilt from its description, so we see the same view.
+    rc = m_hwloc.topology_init(
+        m_config.hwtopo_path, m_config.hwtopo_synthetic
+    );
     if (qvi_unlikely(rc != QV_SUCCESS)) return QV_RES_UNAVAILABLE;
 
-    rc = m_hwloc.topology_load();
+    // Clients do not need bridges or Misc objects, so load a lean topology
+    // unless the full one is requested (e.g., for debugging).
+    const bool lean = !qvi_envset(QVI_ENV_CLIENT_TOPOLOGY_FULL);
+    rc = m_hwloc.topology_load(lean);
     if (qvi_unlikely(rc != QV_SUCCESS)) return QV_RES_UNAVAILABLE;
 
     return QV_SUCCESS;
@@ -430,13 +437,14 @@ qvi_rmi_client::rpc_req(
 ////////////////////////////////////////////////////////////////////////////////
 int
 qvi_rmi_client::m_hello(
-    std::string &hwtopo_path
+    std::string &hwtopo_path,
+    std::string &hwtopo_synthetic
 ) {
     int qvrc = rpc_req(QVI_RMI_FID_HELLO, qvi_gettid());
     if (qvi_unlikely(qvrc != QV_SUCCESS)) return qvrc;
     // Should be set by rpc_rep, so assume an error.
     int rpcrc = QV_ERR_RPC;
-    qvrc = rpc_rep(rpcrc, hwtopo_path);
+    qvrc = rpc_rep(rpcrc, hwtopo_path, hwtopo_synthetic);
     if (qvi_unlikely(qvrc != QV_SUCCESS)) return qvrc;
     return rpcrc;
 }
@@ -554,6 +562,33 @@ qvi_rmi_client::get_cpuset_for_nobjs(
     return rpcrc;
 }
 
+int
+qvi_rmi_client::get_numa_distances(
+    const qvi_hwloc_bitmap &cpuset,
+    qv_hw_distance_kind_t kind,
+    qvi_hwloc_distances &result
+) {
+    const auto key = std::make_pair(
+        kind, qvi_hwloc::bitmap_string(cpuset.cdata())
+    );
+    const auto got = m_numa_distances.find(key);
+    if (got != m_numa_distances.end()) {
+        result = got->second;
+        return QV_SUCCESS;
+    }
+
+    int qvrc = rpc_req(QVI_RMI_FID_GET_NUMA_DISTANCES, cpuset, kind);
+    if (qvi_unlikely(qvrc != QV_SUCCESS)) return qvrc;
+    // Should be set by rpc_rep, so assume an error.
+    int rpcrc = QV_ERR_RPC;
+    qvrc = rpc_rep(rpcrc, result);
+    if (qvi_unlikely(qvrc != QV_SUCCESS)) return qvrc;
+    if (qvi_unlikely(rpcrc != QV_SUCCESS)) return rpcrc;
+
+    m_numa_distances.insert({key, result});
+    return QV_SUCCESS;
+}
+
 int
 qvi_rmi_client::send_shutdown_message(void)
 {
@@ -580,23 +615,10 @@ qvi_rmi_server::qvi_rmi_server(void)
         {QVI_RMI_FID_GET_NOBJS_IN_CPUSET, s_rpc_get_nobjs_in_cpuset},
         {QVI_RMI_FID_GET_CPUSET_FOR_NOBJS, s_rpc_get_cpuset_for_nobjs},
         {QVI_RMI_FID_GET_DEVICE_IN_CPUSET, s_rpc_get_device_in_cpuset},
-        {QVI_RMI_FID_GET_INTRINSIC_HWPOOL, s_rpc_get_intrinsic_hwpool}
+        {QVI_RMI_FID_GET_INTRINSIC_HWPOOL, s_rpc_get_intrinsic_hwpool},
+        {QVI_RMI_FID_GET_NUMA_DISTANCES, s_rpc_get_numa_distances}
     };
 
-    int qvrc = m_hwloc.topology_init();
-    if (qvi_unlikely(qvrc != QV_SUCCESS)) {
-        static cstr_t ers = "hwloc.topology_init() failed";
-        qvi_log_error("{} (rc={}, {})", ers, qvrc, qv_strerr(qvrc));
-        throw qvi_runtime_error(qvrc);
-    }
-
-    qvrc = m_hwloc.topology_load();
-    if (qvi_unlikely(qvrc != QV_SUCCESS)) {
-        static cstr_t ers = "hwloc.topology_load() failed";
-        qvi_log_error("{} (rc={}, {})", ers, qvrc, qv_strerr(qvrc));
-        throw qvi_runtime_error(qvrc);
-    }
-
     m_zctx = zmq_ctx_new();
     if (qvi_unlikely(!m_zctx)) throw qvi_runtime_error(QV_ERR_SYS);
 }
@@ -687,6 +709,20 @@ qvi_rmi_server::s_rpc_get_intrinsic_hwpool(
         if (flags & QV_SCOPE_FLAG_NO_SMT) {
             sbitmap = server->m_hwloc.bitmap_disable_smt(sbitmap);
         }
+        // Restrict to a single kind of core?
+        if (flags & (QV_SCOPE_FLAG_PERF_CORES | QV_SCOPE_FLAG_EFFICIENCY_CORES)) {
+            if ((flags & QV_SCOPE_FLAG_PERF_CORES) &&
+                (flags & QV_SCOPE_FLAG_EFFICIENCY_CORES)) {
+                rpcrc = QV_ERR_INVLD_ARG;
+                break;
+            }
+            qvi_hwloc_bitmap kbitmap;
+            rpcrc = server->m_hwloc.bitmap_restrict_to_cpukind(
+                sbitmap, flags & QV_SCOPE_FLAG_PERF_CORES, kbitmap
+            );
+            if (qvi_unlikely(rpcrc != QV_SUCCESS)) break;
+            sbitmap = kbitmap;
+        }
         rpcrc = hwpool.initialize(server->m_hwloc, sbitmap);
     } while (false);
 
@@ -733,7 +769,8 @@ qvi_rmi_server::s_rpc_hello(
     // Pack relevant configuration information.
     return rpc_pack(
         output, hdr->fid, rpcrc,
-        server->m_config.hwtopo_path
+        server->m_config.hwtopo_path,
+        server->m_config.hwtopo_synthetic
     );
 }
 
@@ -895,6 +932,32 @@ qvi_rmi_server::s_rpc_get_device_in_cpuset(
     return rpc_pack(output, hdr->fid, rpcrc, dev_id);
 }
 
+int
+qvi_rmi_server::s_rpc_get_numa_distances(
+    qvi_rmi_server *server,
+    qvi_rmi_msg_header *hdr,
+    void *input,
+    qvi_bbuff **output
+) {
+    int rpcrc = QV_SUCCESS;
+    qvi_hwloc_distances distances;
+
+    do {
+        qvi_hwloc_bitmap cpuset;
+        qv_hw_distance_kind_t kind;
+        const int qvrc = qvi_bbuff::unpack(input, cpuset, kind);
+        if (qvi_unlikely(qvrc != QV_SUCCESS)) {
+            rpcrc = qvrc;
+            break;
+        }
+        rpcrc = server->m_hwloc.get_numa_distances(
+            cpuset.cdata(), kind, distances
+        );
+    } while (false);
+
+    return rpc_pack(output, hdr->fid, rpcrc, distances);
+}
+
 int
 qvi_rmi_server::m_rpc_dispatch(
     void *zsock,
@@ -962,8 +1025,24 @@ int
 qvi_rmi_server::configure(
     const qvi_rmi_config &config
 ) {
+    if (qvi_unlikely(m_configured)) return QV_ERR_INVLD_ARG;
+    m_configured = true;
+
     m_config = config;
-    return QV_SUCCESS;
+
+    int rc = m_hwloc.topology_init("", m_config.hwtopo_synthetic);
+    if (qvi_unlikely(rc != QV_SUCCESS)) {
+        static cstr_t ers = "hwloc.topology_init() failed";
+        qvi_log_error("{} (rc={}, {})", ers, rc, qv_strerr(rc));
+        return rc;
+    }
+
+    rc = m_hwloc.topology_load();
+    if (qvi_unlikely(rc != QV_SUCCESS)) {
+        static cstr_t ers = "hwloc.topology_load() failed";
+        qvi_log_error("{} (rc={}, {})", ers, rc, qv_strerr(rc));
+    }
+    return rc;
 }
 
 int
@@ -971,7 +1050,11 @@ qvi_rmi_server::topology_export(
     const std::string &base_path,
     std::string &path
 ) {
-    return m_hwloc.topology_export(base_path, path);
+    const int rc = m_hwloc.topology_export(base_path, path);
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+
+    m_config.hwtopo_path = path;
+    return QV_SUCCESS;
 }
 
 int
@@ -36,7 +36,8 @@ enum qvi_rmi_rpc_fid_t {
     QVI_RMI_FID_GET_NOBJS_IN_CPUSET,
     QVI_RMI_FID_GET_CPUSET_FOR_NOBJS,
     QVI_RMI_FID_GET_DEVICE_IN_CPUSET,
-    QVI_RMI_FID_GET_INTRINSIC_HWPOOL
+    QVI_RMI_FID_GET_INTRINSIC_HWPOOL,
+    QVI_RMI_FID_GET_NUMA_DISTANCES
 };
 
 /**
@@ -58,6 +59,11 @@ struct qvi_rmi_config {
     int portno = QVI_PORT_UNSET;
     /** Path to hardware topology file. */
     std::string hwtopo_path;
+    /**
+     * hwloc synthetic topology description. When set, the server and its
+     * clients use this topology instead of the system's.
+     */
+    std::string hwtopo_synthetic;
 };
 
 /**
@@ -69,6 +75,8 @@ private:
     std::map<qvi_rmi_rpc_fid_t, qvi_rmi_rpc_fun_ptr_t> m_rpc_dispatch_table;
     /** Server configuration. */
     qvi_rmi_config m_config;
+    /** Whether configure() was called. */
+    bool m_configured = false;
     /** Maintains hardware locality information. */
     qvi_hwloc m_hwloc;
     /** The base resource pool maintained by the server. */
@@ -191,17 +199,32 @@ private:
         void *input,
         qvi_bbuff **output
     );
+    /** */
+    static int
+    s_rpc_get_numa_distances(
+        qvi_rmi_server *server,
+        qvi_rmi_msg_header *hdr,
+        void *input,
+        qvi_bbuff **output
+    );
 public:
     /** Constructor. */
     qvi_rmi_server(void);
     /** Destructor. */
     ~qvi_rmi_server(void);
-    /** Configures the server's RMI from the provided config. */
+    /**
+     * Configures the server's RMI from the provided config and loads the
+     * hardware topology it describes. May only be called once, since the
+     * loaded topology cannot be replaced.
+     */
     int
     configure(
         const qvi_rmi_config &config
     );
-    /** Exports hardware topology. */
+    /**
+     * Exports hardware topology. The exported file is
+     * advertised to clients and removed at server teardown.
+     */
     int
     topology_export(
         const std::string &base_path,
@@ -227,6 +250,14 @@ private:
     void *m_zsock = nullptr;
     /** Flag indicating whether client is connected to server. */
     bool m_connected = false;
+    /**
+     * Caches NUMA distances keyed by distance kind and cpuset string. The
+     * topology is static, so entries are valid for the client's lifetime.
+     */
+    std::map<
+        std::pair<qv_hw_distance_kind_t, std::string>,
+        qvi_hwloc_distances
+    > m_numa_distances;
     /** Reveives messages. */
     int
     m_recv_msg(
@@ -248,7 +279,8 @@ private:
     /** Performs connection handshake. */
     int
     m_hello(
-        std::string &hwtopo_path
+        std::string &hwtopo_path,
+        std::string &hwtopo_synthetic
     );
 public:
     /** Constructor. */
@@ -322,6 +354,16 @@ public:
         int nobjs,
         qvi_hwloc_bitmap &result
     );
+    /**
+     * Returns the distances between the NUMA nodes local to the provided
+     * cpuset. Results are cached, so repeated queries do not reach the server.
+     */
+    int
+    get_numa_distances(
+        const qvi_hwloc_bitmap &cpuset,
+        qv_hw_distance_kind_t kind,
+        qvi_hwloc_distances &result
+    );
     /** Sends a shutdown message to the server. */
     int
     send_shutdown_message(void);
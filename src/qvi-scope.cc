@@ -15,6 +15,7 @@
  */
 
 #include "qvi-scope.h"
+#include "qvi-coll.h"
 #include "qvi-rmi.h"
 #include "qvi-task.h"
 #include "qvi-hwpool.h"
@@ -29,6 +30,13 @@ qv_scope::qv_scope(
 
 qv_scope::~qv_scope(void)
 {
+    for (auto &slot : m_arenas) {
+        qvi_arena *arena = slot.load();
+        qvi_delete(&arena);
+    }
+    for (auto &memo : m_split_memo) {
+        memo.group->release();
+    }
     m_group->release();
 }
 
@@ -73,10 +81,8 @@ qv_scope::make_intrinsic(
 
 // TODO(skg) Implement use of hints.
 int
-qv_scope::create(
-    qv_hw_obj_type_t type,
-    int nobjs,
-    qv_scope_create_hints_t,
+qv_scope::m_create_from_cpuset(
+    const qvi_hwloc_bitmap &cpuset,
     qv_scope_t **child
 ) {
     *child = nullptr;
@@ -84,19 +90,8 @@ qv_scope::create(
     qvi_group *group = nullptr;
     int rc = m_group->self(&group);
     if (rc != QV_SUCCESS) return rc;
-    // Create the hardware pool.
+    // Create and initialize the new hardware pool.
     qvi_hwpool hwpool;
-    // Get the appropriate cpuset based on the caller's request.
-    qvi_hwloc_bitmap cpuset;
-    rc = m_group->task().rmi().get_cpuset_for_nobjs(
-        m_hwpool.cpuset(), type, nobjs, cpuset
-    );
-    if (rc != QV_SUCCESS) {
-        qvi_delete(&group);
-        return rc;
-    }
-    // Now that we have the desired cpuset,
-    // initialize the new hardware pool.
     rc = hwpool.initialize(m_group->hwloc(), cpuset);
     if (rc != QV_SUCCESS) {
         qvi_delete(&group);
@@ -112,6 +107,41 @@ qv_scope::create(
     return rc;
 }
 
+int
+qv_scope::create(
+    qv_hw_obj_type_t type,
+    int nobjs,
+    qv_scope_create_hints_t,
+    qv_scope_t **child
+) {
+    *child = nullptr;
+    // Get the appropriate cpuset based on the caller's request.
+    qvi_hwloc_bitmap cpuset;
+    const int rc = m_group->task().rmi().get_cpuset_for_nobjs(
+        m_hwpool.cpuset(), type, nobjs, cpuset
+    );
+    if (rc != QV_SUCCESS) return rc;
+    // Now that we have the desired cpuset, create the new scope.
+    return m_create_from_cpuset(cpuset, child);
+}
+
+int
+qv_scope::create_cache(
+    uint64_t nbytes,
+    qv_scope_create_hints_t,
+    qv_scope_t **child
+) {
+    *child = nullptr;
+    // Topology queries are local, so no need to go through the RMI.
+    qvi_hwloc_bitmap cpuset;
+    const int rc = m_group->hwloc().get_cpuset_for_cache_capacity(
+        m_hwpool.cpuset().cdata(), nbytes, cpuset
+    );
+    if (rc != QV_SUCCESS) return rc;
+
+    return m_create_from_cpuset(cpuset, child);
+}
+
 qvi_group &
 qv_scope::group(void) const
 {
@@ -169,6 +199,129 @@ qv_scope::device_id(
     return finfo->id(format, result);
 }
 
+int
+qv_scope::m_obj_numa_index(
+    qv_hw_obj_type_t obj,
+    int obj_index,
+    int *numa_index
+) const {
+    *numa_index = -1;
+    // NUMA nodes are indexed exactly as they are in the distance matrix.
+    if (obj == QV_HW_OBJ_NUMANODE) {
+        *numa_index = obj_index;
+        return QV_SUCCESS;
+    }
+
+    qvi_hwloc &hwloc = m_group->hwloc();
+    hwloc_const_cpuset_t cpuset = m_hwpool.cpuset().cdata();
+    // Host resources are found by their index within the scope's cpuset.
+    if (qvi_hwloc::obj_is_host_resource(obj)) {
+        int depth = 0;
+        int rc = hwloc.obj_type_depth(obj, &depth);
+        if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+
+        hwloc_obj_t hwobj = nullptr;
+        rc = hwloc.get_obj_in_cpuset_by_depth(
+            cpuset, depth, obj_index, &hwobj
+        );
+        if (qvi_unlikely(rc != QV_SUCCESS)) return QV_ERR_NOT_FOUND;
+
+        return hwloc.get_numa_index_in_cpuset(
+            cpuset, hwobj->cpuset, numa_index
+        );
+    }
+    // Devices are found in the scope's hardware pool.
+    int id = 0;
+    for (const auto &dinfo : m_hwpool.devices()) {
+        if (obj != dinfo.first) continue;
+        if (id++ != obj_index) continue;
+        return hwloc.get_numa_index_in_cpuset(
+            cpuset, dinfo.second->affinity().cdata(), numa_index
+        );
+    }
+    return QV_ERR_NOT_FOUND;
+}
+
+int
+qv_scope::numa_distances(
+    qv_hw_distance_kind_t kind,
+    int *nnodes,
+    uint64_t **matrix
+) const {
+    *nnodes = 0;
+    *matrix = nullptr;
+
+    qvi_hwloc_distances distances;
+    const int rc = m_group->task().rmi().get_numa_distances(
+        m_hwpool.cpuset(), kind, distances
+    );
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+    // Nothing to copy out.
+    if (distances.nnodes == 0) return QV_SUCCESS;
+
+    const size_t nbytes = distances.values.size() * sizeof(uint64_t);
+    uint64_t *imatrix = (uint64_t *)malloc(nbytes);
+    if (qvi_unlikely(!imatrix)) return QV_ERR_OOR;
+    memcpy(imatrix, distances.values.data(), nbytes);
+
+    *nnodes = int(distances.nnodes);
+    *matrix = imatrix;
+    return QV_SUCCESS;
+}
+
+int
+qv_scope::hw_obj_distance(
+    qv_hw_obj_type_t obj,
+    int obj_index_a,
+    int obj_index_b,
+    qv_hw_distance_kind_t kind,
+    uint64_t *distance
+) const {
+    *distance = 0;
+
+    qvi_hwloc_distances distances;
+    int rc = m_group->task().rmi().get_numa_distances(
+        m_hwpool.cpuset(), kind, distances
+    );
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+
+    int numa_a = 0, numa_b = 0;
+    rc = m_obj_numa_index(obj, obj_index_a, &numa_a);
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+    rc = m_obj_numa_index(obj, obj_index_b, &numa_b);
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+
+    const int nnodes = int(distances.nnodes);
+    if (qvi_unlikely(numa_a >= nnodes || numa_b >= nnodes)) {
+        return QV_ERR_NOT_FOUND;
+    }
+    *distance = distances.values[numa_a * nnodes + numa_b];
+    return QV_SUCCESS;
+}
+
+int
+qv_scope::numa_attr(
+    int numa_index,
+    qv_numa_attr_t attr,
+    uint64_t *value
+) const {
+    *value = 0;
+
+    const qvi_hwpool_mems_t &mems = m_hwpool.mems();
+    if (qvi_unlikely(numa_index >= int(mems.size()))) {
+        return QV_ERR_INVLD_ARG;
+    }
+    return mems[numa_index].attr(attr, value);
+}
+
+int
+qv_scope::numa_best(
+    qv_numa_attr_t attr,
+    int *numa_index
+) const {
+    return m_hwpool.mem_best(attr, numa_index);
+}
+
 int
 qv_scope::group_barrier(void)
 {
@@ -181,6 +334,12 @@ qv_scope::bind_push(void)
     return m_group->task().bind_push(m_hwpool.cpuset());
 }
 
+int
+qv_scope::bind_push_assumed(void)
+{
+    return m_group->task().bind_push_assumed(m_hwpool.cpuset());
+}
+
 int
 qv_scope::bind_pop(void)
 {
@@ -201,27 +360,174 @@ qv_scope::bind_string(
     return m_group->hwloc().bind_string(bitmap.cdata(), flags, result);
 }
 
+int
+qv_scope::membind_push(
+    qv_membind_policy_t policy
+) {
+    qvi_hwloc_bitmap nodeset;
+    const int rc = m_hwpool.mem_nodeset(nodeset);
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+
+    return m_group->task().membind_push(nodeset, policy);
+}
+
+int
+qv_scope::membind_push_tier(
+    qv_membind_policy_t policy,
+    qv_numa_attr_t attr
+) {
+    qvi_hwloc_bitmap nodeset;
+    const int rc = m_hwpool.mem_tier_nodeset(attr, nodeset);
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+
+    return m_group->task().membind_push(nodeset, policy);
+}
+
+int
+qv_scope::membind_pop(void)
+{
+    return m_group->task().membind_pop();
+}
+
+int
+qv_scope::m_arena_get(
+    bool huge_pages,
+    qvi_arena **arena
+) {
+    std::atomic<qvi_arena *> &slot = m_arenas[huge_pages ? 1 : 0];
+    // Only the first allocation takes the lock.
+    qvi_arena *iarena = slot.load(std::memory_order_acquire);
+    if (qvi_unlikely(!iarena)) {
+        std::lock_guard<std::mutex> guard(m_arenas_mutex);
+        iarena = slot.load(std::memory_order_relaxed);
+        if (!iarena) {
+            qvi_hwloc_bitmap nodeset;
+            int rc = m_hwpool.mem_nodeset(nodeset);
+            if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+
+            rc = qvi_new(&iarena, m_group->hwloc(), nodeset, huge_pages);
+            if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+            slot.store(iarena, std::memory_order_release);
+        }
+    }
+    *arena = iarena;
+    return QV_SUCCESS;
+}
+
+int
+qv_scope::mem_alloc(
+    size_t size,
+    qv_scope_malloc_flags_t flags,
+    void **ptr
+) {
+    qvi_arena *arena = nullptr;
+    const bool huge_pages = flags & QV_SCOPE_MALLOC_HUGE_PAGES;
+    const int rc = m_arena_get(huge_pages, &arena);
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+
+    return arena->malloc(size, ptr);
+}
+
+int
+qv_scope::mem_free(
+    void *ptr
+) {
+    qvi_arena *arena = qvi_arena::owner(ptr);
+    // Only accept memory allocated through this scope. Arenas that do not
+    // exist yet are null, so a null owner must not be compared with them.
+    if (qvi_unlikely(!arena)) return QV_ERR_INVLD_ARG;
+    if (qvi_unlikely(arena != m_arenas[0].load(std::memory_order_acquire) &&
+                     arena != m_arenas[1].load(std::memory_order_acquire))) {
+        return QV_ERR_INVLD_ARG;
+    }
+    return arena->free(ptr);
+}
+
+int64_t
+qv_scope::m_split_memo_find(
+    const qvi_scope_split_memo &key
+) const {
+    for (const auto &entry : m_split_memo) {
+        if (entry.npieces == key.npieces && entry.color == key.color &&
+            entry.type == key.type && entry.weight == key.weight &&
+            entry.affinity == key.affinity) {
+            return entry.id;
+        }
+    }
+    return -1;
+}
+
+void
+qv_scope::m_split_memo_insert(
+    qvi_scope_split_memo &key,
+    const qvi_hwpool &hwpool,
+    qvi_group *group
+) {
+    if (m_split_memo.size() == s_split_memo_max) {
+        m_split_memo.front().group->release();
+        m_split_memo.pop_front();
+    }
+    key.hwpool = hwpool;
+    key.group = group;
+    group->retain();
+    m_split_memo.push_back(key);
+}
+
 int
 qv_scope::split(
     int npieces,
     int color,
     qv_hw_obj_type_t maybe_obj_type,
-    qv_scope_t **child
+    qv_scope_t **child,
+    int weight
 ) {
     qvi_group *group = nullptr;
     qv_scope_t *ichild = nullptr;
-    // Split the hardware resources based on the provided split parameters.
+    int64_t memo_hit = -1;
     int colorp = 0;
     qvi_hwpool hwpool;
-    int rc = qvi_hwsplit::split(
-        this, npieces, color, maybe_obj_type, &colorp, hwpool
+    // Key the split on its parameters and our affinity.
+    qvi_scope_split_memo key;
+    key.npieces = npieces;
+    key.color = color;
+    key.type = maybe_obj_type;
+    key.weight = weight;
+    int rc = m_group->task().bind_top(key.affinity);
+    if (qvi_unlikely(rc != QV_SUCCESS)) goto out;
+    // Split the hardware resources based on the provided split parameters,
+    // unless every member has the result memoized: the split depends on the
+    // parameters and affinities of the whole group.
+    rc = qvi_hwsplit::split(
+        this, npieces, color, maybe_obj_type, m_split_memo_find(key),
+        &memo_hit, &colorp, hwpool, weight
     );
     if (qvi_unlikely(rc != QV_SUCCESS)) goto out;
+    if (memo_hit >= 0) {
+        for (const auto &entry : m_split_memo) {
+            if (entry.id != memo_hit) continue;
+            hwpool = entry.hwpool;
+            group = entry.group;
+            group->retain();
+            break;
+        }
+        rc = qvi_new(&ichild, group, hwpool);
+        if (qvi_unlikely(rc != QV_SUCCESS)) {
+            group->release();
+            group = nullptr;
+        }
+        goto out;
+    }
+    // Every member reaches this point together, so IDs taken here agree
+    // across members even if a member fails below and memoizes nothing.
+    key.id = m_split_memo_next++;
     // Split underlying group. Notice the use of colorp here.
     rc = m_group->split(colorp, m_group->rank(), &group);
     if (qvi_unlikely(rc != QV_SUCCESS)) goto out;
     // Create and initialize the new scope.
     rc = qvi_new(&ichild, group, hwpool);
+    if (qvi_unlikely(rc != QV_SUCCESS)) goto out;
+
+    m_split_memo_insert(key, hwpool, group);
 out:
     if (qvi_unlikely(rc != QV_SUCCESS)) {
         qvi_delete(&group);
@@ -231,13 +537,38 @@ out:
     return rc;
 }
 
+int
+qv_scope::split_weighted(
+    int weight,
+    qv_scope_t **child
+) {
+    // Every member gets its own piece.
+    return split(
+        m_group->size(), m_group->rank(), QV_HW_OBJ_LAST, child, weight
+    );
+}
+
+int
+qv_scope::m_split_at_npieces(
+    qv_hw_obj_type_t type
+) const {
+    if (type != QV_HW_OBJ_NUMANODE) return hwpool_nobjects(type);
+    // NUMA nodes local to the same CPUs are memory tiers of one piece.
+    qvi_hwloc_bitmaps domains;
+    const int rc = m_group->hwloc().get_numa_domain_cpusets_in_cpuset(
+        m_hwpool.cpuset().cdata(), domains
+    );
+    if (qvi_unlikely(rc != QV_SUCCESS)) throw qvi_runtime_error(rc);
+    return domains.size();
+}
+
 int
 qv_scope::split_at(
     qv_hw_obj_type_t type,
     int color,
     qv_scope_t **child
 ) {
-    return split(hwpool_nobjects(type), color, type, child);
+    return split(m_split_at_npieces(type), color, type, child);
 }
 
 int
@@ -252,35 +583,32 @@ qv_scope::thread_split(
     const uint_t group_size = k;
     // Split the hardware, get the hardware pools.
     std::vector<qvi_hwpool> hwpools;
-    std::vector<int> colorps;
     int rc = qvi_hwsplit::thread_split(
-        this, npieces, kcolors, k, maybe_obj_type, colorps, hwpools
+        this, npieces, kcolors, k, maybe_obj_type, hwpools
     );
     if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
     // Split off from our parent group. This call is called from a context in
     // which a process is splitting its resources across threads, so create a
     // new thread group that will be shared with each child (see below).
-    qvi_group *thgroup = nullptr;
-    rc = m_group->thread_split(group_size, colorps, &thgroup);
+    std::vector<qvi_group *> thgroups;
+    rc = m_group->thread_split(group_size, thgroups);
     if (rc != QV_SUCCESS) return rc;
-    // Now create and populate the children.
-    qv_scope_t **ithchildren = new qv_scope_t *[group_size];
+    // Now create and populate the children, each with its own group member.
+    qv_scope_t **ithchildren = new qv_scope_t *[group_size]();
     for (uint_t i = 0; i < group_size; ++i) {
-        // Create and initialize the new scope.
+        // Create and initialize the new scope, which takes over the member.
         qv_scope_t *child = nullptr;
-        rc = qvi_new(&child, thgroup, hwpools[i]);
+        rc = qvi_new(&child, thgroups[i], hwpools[i]);
         if (rc != QV_SUCCESS) break;
-        thgroup->retain();
+        thgroups[i] = nullptr;
         ithchildren[i] = child;
     }
     if (qvi_unlikely(rc != QV_SUCCESS)) {
+        for (auto &thgroup : thgroups) {
+            qvi_delete(&thgroup);
+        }
         qv_scope::thread_destroy(&ithchildren, k);
     }
-    else {
-        // Subtract one to account for the parent's
-        // implicit retain during construct.
-        thgroup->release();
-    }
     *thchildren = ithchildren;
     return rc;
 }
@@ -292,7 +620,9 @@ qv_scope::thread_split_at(
     uint_t k,
     qv_scope_t ***kchildren
 ) {
-    return thread_split(hwpool_nobjects(type), kcolors, k, type, kchildren);
+    return thread_split(
+        m_split_at_npieces(type), kcolors, k, type, kchildren
+    );
 }
 
 /*
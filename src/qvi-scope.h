@@ -20,13 +20,93 @@
 #include "qvi-common.h"
 #include "qvi-group.h"
 #include "qvi-hwpool.h"
+#include "qvi-arena.h"
+
+/**
+ * A memoized split result. Entry IDs are taken collectively, so equal IDs
+ * denote the same split across all members of the splitting group.
+ */
+struct qvi_scope_split_memo {
+    /** Entry ID. */
+    int64_t id = -1;
+    /** Split parameters. */
+    int npieces = 0;
+    int color = 0;
+    qv_hw_obj_type_t type = QV_HW_OBJ_LAST;
+    int weight = 0;
+    /** The caller's affinity at split time. */
+    qvi_hwloc_bitmap affinity;
+    /** The caller's resulting hardware pool. */
+    qvi_hwpool hwpool;
+    /** The caller's resulting group. Retained by the memo. */
+    qvi_group *group = nullptr;
+};
 
 struct qv_scope {
 private:
+    /** Maximum number of memoized split results. */
+    static constexpr size_t s_split_memo_max = 8;
     /** Task group associated with this scope instance. */
     qvi_group *m_group = nullptr;
     /** Hardware resource pool. */
     qvi_hwpool m_hwpool;
+    /** Serializes lazy arena creation. */
+    std::mutex m_arenas_mutex;
+    /**
+     * NUMA-local arenas, indexed by whether they use huge pages. Set once
+     * under m_arenas_mutex, then read without locking.
+     */
+    std::array<std::atomic<qvi_arena *>, 2> m_arenas = {};
+    /** Memoized split results, oldest first. */
+    std::list<qvi_scope_split_memo> m_split_memo;
+    /** ID of the next memoized split result. */
+    int64_t m_split_memo_next = 0;
+    /** Creates a new scope with the provided cpuset. */
+    int
+    m_create_from_cpuset(
+        const qvi_hwloc_bitmap &cpuset,
+        qv_scope_t **child
+    );
+    /**
+     * Returns the ID of the memoized split result matching the provided key,
+     * or -1 if there is none. The result may only be used if every member of
+     * the group finds the same ID.
+     */
+    int64_t
+    m_split_memo_find(
+        const qvi_scope_split_memo &key
+    ) const;
+    /** Memoizes a split result, evicting the oldest entry when full. */
+    void
+    m_split_memo_insert(
+        qvi_scope_split_memo &key,
+        const qvi_hwpool &hwpool,
+        qvi_group *group
+    );
+    /** Returns the scope's arena, creating it if needed. */
+    int
+    m_arena_get(
+        bool huge_pages,
+        qvi_arena **arena
+    );
+    /**
+     * Returns the index of the NUMA node local to the requested object. The
+     * index is relative to the NUMA nodes local to the scope.
+     */
+    int
+    m_obj_numa_index(
+        qv_hw_obj_type_t obj,
+        int obj_index,
+        int *numa_index
+    ) const;
+    /**
+     * Returns the number of pieces split_at() makes of the provided type:
+     * its number of objects, except that NUMA nodes split by domain.
+     */
+    int
+    m_split_at_npieces(
+        qv_hw_obj_type_t type
+    ) const;
 public:
     /** Constructor */
     qv_scope(void) = delete;
@@ -56,6 +136,16 @@ public:
         qv_scope_create_hints_t hints,
         qv_scope_t **child
     );
+    /**
+     * Creates a new scope with a greedily chosen set of
+     * cores whose caches together hold a working set of nbytes.
+     */
+    int
+    create_cache(
+        uint64_t nbytes,
+        qv_scope_create_hints_t hints,
+        qv_scope_t **child
+    );
     /** Destroys scopes created by thread_split*. */
     static void
     thread_destroy(
@@ -94,8 +184,46 @@ public:
         char **result
     ) const;
 
+    /**
+     * Returns the distance matrix of the NUMA nodes local to the scope.
+     */
+    int
+    numa_distances(
+        qv_hw_distance_kind_t kind,
+        int *nnodes,
+        uint64_t **matrix
+    ) const;
+    /** Returns the distance between two hardware objects in the scope. */
+    int
+    hw_obj_distance(
+        qv_hw_obj_type_t obj,
+        int obj_index_a,
+        int obj_index_b,
+        qv_hw_distance_kind_t kind,
+        uint64_t *distance
+    ) const;
+    /** Returns a memory attribute of the NUMA node at the provided index. */
+    int
+    numa_attr(
+        int numa_index,
+        qv_numa_attr_t attr,
+        uint64_t *value
+    ) const;
+    /** Returns the index of the NUMA node with the best attribute value. */
+    int
+    numa_best(
+        qv_numa_attr_t attr,
+        int *numa_index
+    ) const;
+
     int
     bind_push(void);
+    /**
+     * Pushes the scope's binding without changing the caller's
+     * affinity, which must already match it (see qv_pthread_create).
+     */
+    int
+    bind_push_assumed(void);
 
     int
     bind_pop(void);
@@ -106,6 +234,32 @@ public:
         char **result
     );
 
+    int
+    membind_push(
+        qv_membind_policy_t policy
+    );
+
+    int
+    membind_push_tier(
+        qv_membind_policy_t policy,
+        qv_numa_attr_t attr
+    );
+
+    int
+    membind_pop(void);
+
+    int
+    mem_alloc(
+        size_t size,
+        qv_scope_malloc_flags_t flags,
+        void **ptr
+    );
+
+    int
+    mem_free(
+        void *ptr
+    );
+
     int
     thread_split(
         uint_t npieces,
@@ -123,11 +277,22 @@ public:
         qv_scope_t ***kchildren
     );
 
+    /**
+     * Splits the scope. Repeated identical splits of this scope are served
+     * from a memo, in which case the resulting subscopes share a group.
+     */
     int
     split(
         int ncolors,
         int color,
         qv_hw_obj_type_t maybe_obj_type,
+        qv_scope_t **child,
+        int weight = 0
+    );
+    /** Splits into one piece per member, sized by the members' weights. */
+    int
+    split_weighted(
+        int weight,
         qv_scope_t **child
     );
 
@@ -17,6 +17,26 @@
 #include "qvi-task.h"
 #include "qvi-utils.h"
 
+static int
+membind_policy_qv2hwloc(
+    qv_membind_policy_t policy,
+    hwloc_membind_policy_t &hpolicy
+) {
+    switch (policy) {
+        case QV_MEMBIND_BIND:
+            hpolicy = HWLOC_MEMBIND_BIND;
+            return QV_SUCCESS;
+        case QV_MEMBIND_INTERLEAVE:
+            hpolicy = HWLOC_MEMBIND_INTERLEAVE;
+            return QV_SUCCESS;
+        case QV_MEMBIND_FIRSTTOUCH:
+            hpolicy = HWLOC_MEMBIND_FIRSTTOUCH;
+            return QV_SUCCESS;
+        default:
+            return QV_ERR_INVLD_ARG;
+    }
+}
+
 pid_t
 qvi_task::mytid(void)
 {
@@ -77,6 +97,22 @@ qvi_task::m_init_bind_stack(void)
     return QV_SUCCESS;
 }
 
+int
+qvi_task::m_init_membind_stack(void)
+{
+    // Cache current memory binding.
+    qvi_task_membind current;
+    const int rc = hwloc().thread_get_membind(current.nodeset, current.policy);
+    // Tasks that never bind memory must work where memory bindings cannot be
+    // queried, so seed the stack with the default binding in that case.
+    if (qvi_unlikely(rc != QV_SUCCESS)) {
+        m_membind_supported = false;
+        current = qvi_task_membind();
+    }
+    m_membind_stack.push(current);
+    return QV_SUCCESS;
+}
+
 int
 qvi_task::connect_to_server(void)
 {
@@ -84,7 +120,10 @@ qvi_task::connect_to_server(void)
     int rc = m_connect_to_server();
     if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
     // Initialize our bind stack.
-    return m_init_bind_stack();
+    rc = m_init_bind_stack();
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+    // Initialize our memory bind stack.
+    return m_init_membind_stack();
 }
 
 int
@@ -99,6 +138,14 @@ qvi_task::bind_push(
     return rc;
 }
 
+int
+qvi_task::bind_push_assumed(
+    const qvi_hwloc_bitmap &cpuset
+) {
+    m_stack.push(cpuset);
+    return QV_SUCCESS;
+}
+
 int
 qvi_task::bind_pop(void)
 {
@@ -114,6 +161,40 @@ qvi_task::bind_top(
     return result.set(m_stack.top().cdata());
 }
 
+int
+qvi_task::membind_push(
+    const qvi_hwloc_bitmap &nodeset,
+    qv_membind_policy_t policy
+) {
+    if (qvi_unlikely(!m_membind_supported)) return QV_ERR_NOT_SUPPORTED;
+
+    qvi_task_membind membind;
+    int rc = membind_policy_qv2hwloc(policy, membind.policy);
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+
+    rc = membind.nodeset.set(nodeset.cdata());
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+    // Change policy
+    rc = hwloc().thread_set_membind(membind.nodeset.cdata(), membind.policy);
+    if (qvi_unlikely(rc != QV_SUCCESS)) return rc;
+    // Push binding onto stack.
+    m_membind_stack.push(membind);
+    return rc;
+}
+
+int
+qvi_task::membind_pop(void)
+{
+    if (qvi_unlikely(!m_membind_supported)) return QV_ERR_NOT_SUPPORTED;
+    // Never pop the binding that was in effect at initialization.
+    if (qvi_unlikely(m_membind_stack.size() <= 1)) return QV_ERR_INVLD_ARG;
+
+    m_membind_stack.pop();
+
+    const qvi_task_membind &top = m_membind_stack.top();
+    return hwloc().thread_set_membind(top.nodeset.cdata(), top.policy);
+}
+
 /*
  * vim: ft=cpp ts=4 sts=4 sw=4 expandtab
  */
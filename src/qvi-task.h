@@ -23,18 +23,33 @@
 
 using qvi_task_bind_stack = std::stack<qvi_hwloc_bitmap>;
 
+/** A memory binding: a NUMA nodeset and the policy applied to it. */
+struct qvi_task_membind {
+    qvi_hwloc_bitmap nodeset;
+    hwloc_membind_policy_t policy = HWLOC_MEMBIND_DEFAULT;
+};
+
+using qvi_task_membind_stack = std::stack<qvi_task_membind>;
+
 struct qvi_task {
 private:
     /** Client-side connection to the RMI. */
     qvi_rmi_client m_rmi;
     /** The task's bind stack. */
     qvi_task_bind_stack m_stack;
+    /** The task's memory bind stack. */
+    qvi_task_membind_stack m_membind_stack;
+    /** Whether the calling thread's memory binding could be queried. */
+    bool m_membind_supported = true;
     /** Implements the RMI server connection. */
     int
     m_connect_to_server(void);
     /** Initializes the bind stack. */
     int
     m_init_bind_stack(void);
+    /** Initializes the memory bind stack. */
+    int
+    m_init_membind_stack(void);
 public:
     /** Returns the caller's thread ID. */
     static pid_t
@@ -65,6 +80,14 @@ public:
     bind_push(
         const qvi_hwloc_bitmap &cpuset
     );
+    /**
+     * Stores the cpuset to the top of the task's bind stack without changing
+     * the task's affinity, which must already match it.
+     */
+    int
+    bind_push_assumed(
+        const qvi_hwloc_bitmap &cpuset
+    );
     /**
      * Removes the cpuset from the top of the bind stack
      * and changes the task's affinity to that value.
@@ -76,6 +99,24 @@ public:
     bind_top(
         qvi_hwloc_bitmap &result
     );
+    /**
+     * Binds the calling thread's memory to the provided NUMA nodeset using
+     * the given policy. Also stores the binding to the top of the task's
+     * memory bind stack. Returns QV_ERR_NOT_SUPPORTED if the task's
+     * memory binding could not be queried at initialization.
+     */
+    int
+    membind_push(
+        const qvi_hwloc_bitmap &nodeset,
+        qv_membind_policy_t policy
+    );
+    /**
+     * Removes the binding from the top of the memory bind stack
+     * and restores the calling thread's previous memory binding. Returns
+     * QV_ERR_NOT_SUPPORTED if membind_push() does.
+     */
+    int
+    membind_pop(void);
 };
 
 #endif
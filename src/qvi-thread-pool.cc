@@ -0,0 +1,235 @@
+/* -*- Mode: C++; c-basic-offset:4; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c)      2025 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the quo-vadis project. See the LICENSE file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * @file qvi-thread-pool.cc
+ */
+
+#include "qvi-thread-pool.h"
+#include "qvi-scope.h"
+#include "qvi-utils.h"
+
+/** The pool the calling thread works for, if any. */
+static thread_local const qv_thread_pool *t_pool = nullptr;
+/** The calling thread's worker index in t_pool. */
+static thread_local int t_index = -1;
+
+qv_thread_pool::qv_thread_pool(
+    qv_scope_t *scope,
+    int npieces,
+    int *kcolors,
+    int k
+) : m_workers(k)
+{
+    const int rc = scope->thread_split(
+        npieces, kcolors, k, QV_HW_OBJ_LAST, &m_subscopes
+    );
+    if (qvi_unlikely(rc != QV_SUCCESS)) throw qvi_runtime_error(rc);
+
+    for (int i = 0; i < k; ++i) {
+        m_workers[i].scope = m_subscopes[i];
+    }
+    m_order_victims();
+
+    for (int i = 0; i < k; ++i) {
+        try {
+            m_workers[i].thread = std::thread(&qv_thread_pool::m_work, this, i);
+        }
+        catch (const std::system_error &) {
+            m_stop_workers();
+            qv_scope::thread_destroy(&m_subscopes, k);
+            throw qvi_runtime_error(QV_ERR_OOR);
+        }
+    }
+}
+
+qv_thread_pool::~qv_thread_pool(void)
+{
+    if (t_pool != this) wait();
+    m_stop_workers();
+    qv_scope::thread_destroy(&m_subscopes, m_workers.size());
+}
+
+void
+qv_thread_pool::m_order_victims(void)
+{
+    // Levels of sharing, nearest first.
+    static constexpr qv_hw_obj_type_t levels[] = {
+        QV_HW_OBJ_L2CACHE, QV_HW_OBJ_L3CACHE,
+        QV_HW_OBJ_NUMANODE, QV_HW_OBJ_PACKAGE
+    };
+    static constexpr int nlevels = sizeof(levels) / sizeof(levels[0]);
+    const int nworkers = m_workers.size();
+    if (nworkers == 0) return;
+
+    qvi_hwloc &hwloc = m_workers[0].scope->group().hwloc();
+    // The indices of the objects each worker's cpuset
+    // overlaps, per level. A worker may span several.
+    std::vector<std::array<qvi_hwloc_bitmap, nlevels>> objs(nworkers);
+    for (int l = 0; l < nlevels; ++l) {
+        qvi_hwloc_bitmaps level_cpusets;
+        const int rc = hwloc.get_obj_cpusets_in_cpuset(
+            levels[l], hwloc.topology_get_disallowed_cpuset(), level_cpusets
+        );
+        if (qvi_unlikely(rc != QV_SUCCESS)) throw qvi_runtime_error(rc);
+
+        for (int w = 0; w < nworkers; ++w) {
+            const hwloc_const_cpuset_t cpuset =
+                m_workers[w].scope->hwpool().cpuset().cdata();
+            for (size_t i = 0; i < level_cpusets.size(); ++i) {
+                if (!hwloc_bitmap_intersects(
+                        level_cpusets[i].cdata(), cpuset)) continue;
+                hwloc_bitmap_set(objs[w][l].data(), i);
+            }
+        }
+    }
+    // The first level at which two workers' cpusets share an object.
+    auto distance = [&](int a, int b) {
+        for (int l = 0; l < nlevels; ++l) {
+            if (hwloc_bitmap_intersects(
+                    objs[a][l].cdata(), objs[b][l].cdata())) return l;
+        }
+        return nlevels;
+    };
+    // Steal from the nearest workers first, and spread
+    // the workers at the same distance across thieves.
+    for (int w = 0; w < nworkers; ++w) {
+        std::vector<int> &victims = m_workers[w].victims;
+        for (int v = 0; v < nworkers; ++v) {
+            if (v != w) victims.push_back(v);
+        }
+        std::stable_sort(victims.begin(), victims.end(), [&](int a, int b) {
+            const int da = distance(w, a), db = distance(w, b);
+            if (da != db) return da < db;
+            return (a - w + nworkers) % nworkers < (b - w + nworkers) % nworkers;
+        });
+    }
+}
+
+bool
+qv_thread_pool::m_take(
+    int index,
+    qvi_thread_pool_task &task
+) {
+    qvi_thread_pool_worker &self = m_workers[index];
+    {
+        std::lock_guard<std::mutex> guard(self.mutex);
+        if (!self.tasks.empty()) {
+            task = self.tasks.back();
+            self.tasks.pop_back();
+            m_queued.fetch_sub(1);
+            return true;
+        }
+    }
+    for (const int v : self.victims) {
+        qvi_thread_pool_worker &victim = m_workers[v];
+        std::lock_guard<std::mutex> guard(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            m_queued.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void
+qv_thread_pool::m_run(
+    const qvi_thread_pool_task &task
+) {
+    task.routine(task.arg);
+    if (m_pending.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_done_cv.notify_all();
+    }
+}
+
+void
+qv_thread_pool::m_work(
+    int index
+) {
+    t_pool = this;
+    t_index = index;
+
+    const int rc = m_workers[index].scope->bind_push();
+    if (qvi_unlikely(rc != QV_SUCCESS)) {
+        qvi_log_error(
+            "An error occurred in bind_push(): {} ({})", rc, qv_strerr(rc)
+        );
+    }
+
+    qvi_thread_pool_task task;
+    while (true) {
+        if (m_take(index, task)) {
+            m_run(task);
+            continue;
+        }
+        if (m_stop.load()) break;
+        // Announce that we are about to sleep before checking for work, so
+        // that a submitter either sees us sleeping or we see its task.
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_nsleeping.fetch_add(1);
+        m_work_cv.wait(lock, [&] {
+            return m_queued.load() > 0 || m_stop.load();
+        });
+        m_nsleeping.fetch_sub(1);
+    }
+}
+
+void
+qv_thread_pool::m_stop_workers(void)
+{
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_stop.store(true);
+    }
+    m_work_cv.notify_all();
+    for (auto &worker : m_workers) {
+        if (worker.thread.joinable()) worker.thread.join();
+    }
+}
+
+int
+qv_thread_pool::submit(
+    void (*routine)(void *),
+    void *arg
+) {
+    // Workers keep the tasks they submit, others spread theirs.
+    const size_t index = (t_pool == this) ? t_index :
+        m_next_worker.fetch_add(1) % m_workers.size();
+    qvi_thread_pool_worker &worker = m_workers[index];
+
+    m_pending.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> guard(worker.mutex);
+        worker.tasks.push_back({routine, arg});
+        m_queued.fetch_add(1);
+    }
+    if (m_nsleeping.load() > 0) {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_work_cv.notify_one();
+    }
+    return QV_SUCCESS;
+}
+
+int
+qv_thread_pool::wait(void)
+{
+    // A worker waiting on its own pool would wait on itself.
+    if (qvi_unlikely(t_pool == this)) return QV_ERR_INVLD_ARG;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done_cv.wait(lock, [&] { return m_pending.load() == 0; });
+    return QV_SUCCESS;
+}
+
+/*
+ * vim: ft=cpp ts=4 sts=4 sw=4 expandtab
+ */
@@ -0,0 +1,122 @@
+/* -*- Mode: C++; c-basic-offset:4; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c)      2025 Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the quo-vadis project. See the LICENSE file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * @file qvi-thread-pool.h
+ */
+
+#ifndef QVI_THREAD_POOL_H
+#define QVI_THREAD_POOL_H
+
+#include "qvi-common.h"
+#include "quo-vadis-thread.h"
+
+/** A task submitted to a thread pool. */
+struct qvi_thread_pool_task {
+    void (*routine)(void *) = nullptr;
+    void *arg = nullptr;
+};
+
+/** A pool worker. Aligned so that workers do not share cache lines. */
+struct alignas(64) qvi_thread_pool_worker {
+    /** The subscope the worker is bound to. */
+    qv_scope_t *scope = nullptr;
+    /** Protects tasks. */
+    std::mutex mutex;
+    /**
+     * The worker's tasks. The owner takes from the back, so that it runs its
+     * most recent (and likely cache-hot) task, while thieves take from the
+     * front.
+     */
+    std::deque<qvi_thread_pool_task> tasks;
+    /** Indices of the workers to steal from, nearest first. */
+    std::vector<int> victims;
+    /** The worker thread. */
+    std::thread thread;
+};
+
+/**
+ * A pool of persistent workers, each bound to a subscope of a thread split.
+ * Idle workers steal from the workers that share the most hardware with them.
+ */
+struct qv_thread_pool {
+private:
+    /** The workers. */
+    std::vector<qvi_thread_pool_worker> m_workers;
+    /** The subscopes the workers are bound to. */
+    qv_scope_t **m_subscopes = nullptr;
+    /** Number of tasks sitting in the workers' deques. */
+    std::atomic<int64_t> m_queued = {0};
+    /** Number of submitted tasks that have not yet completed. */
+    std::atomic<int64_t> m_pending = {0};
+    /** Number of workers sleeping, or about to, on m_work_cv. */
+    std::atomic<int> m_nsleeping = {0};
+    /** Tells the workers to exit. */
+    std::atomic<bool> m_stop = {false};
+    /** Worker that receives the next task submitted from outside the pool. */
+    std::atomic<size_t> m_next_worker = {0};
+    /** Protects sleeping on m_work_cv and m_done_cv. */
+    std::mutex m_mutex;
+    /** Signaled when there is work or the pool is stopping. */
+    std::condition_variable m_work_cv;
+    /** Signaled when m_pending drops to zero. */
+    std::condition_variable m_done_cv;
+    /** Orders each worker's victims by locality. */
+    void
+    m_order_victims(void);
+    /** Takes a task from the worker's deque, or steals one. */
+    bool
+    m_take(
+        int index,
+        qvi_thread_pool_task &task
+    );
+    /** Runs the provided task. */
+    void
+    m_run(
+        const qvi_thread_pool_task &task
+    );
+    /** The worker loop. */
+    void
+    m_work(
+        int index
+    );
+    /** Stops and joins the workers started so far. */
+    void
+    m_stop_workers(void);
+public:
+    /** Constructor. */
+    qv_thread_pool(void) = delete;
+    /** Constructor. Splits scope k ways and starts a worker per piece. */
+    qv_thread_pool(
+        qv_scope_t *scope,
+        int npieces,
+        int *kcolors,
+        int k
+    );
+    /** Destructor. Waits for outstanding tasks. */
+    ~qv_thread_pool(void);
+    /** Submits a task to the pool. */
+    int
+    submit(
+        void (*routine)(void *),
+        void *arg
+    );
+    /**
+     * Waits until all submitted tasks, including the ones they submitted,
+     * have completed. May not be called from a pool worker.
+     */
+    int
+    wait(void);
+};
+
+#endif
+
+/*
+ * vim: ft=cpp ts=4 sts=4 sw=4 expandtab
+ */
@@ -57,6 +57,49 @@ qvi_envset(
     return (getenv(varname.c_str()) != nullptr);
 }
 
+/**
+ * Returns the value in microseconds of the provided
+ * environment variable, or defval if unset or invalid.
+ */
+static std::chrono::microseconds
+env_microseconds(
+    const std::string &varname,
+    std::chrono::microseconds defval
+) {
+    const cstr_t val = getenv(varname.c_str());
+    if (!val) return defval;
+    try {
+        const int us = qvi_stoi(val);
+        if (us >= 0) return std::chrono::microseconds(us);
+    }
+    catch (const qvi_rterror &) { }
+    qvi_log_warn("Ignoring invalid {}={}", varname, val);
+    return defval;
+}
+
+const qvi_wait_params &
+qvi_wait_params_env(void)
+{
+    static const qvi_wait_params params = [] {
+        qvi_wait_params iparams;
+        iparams.low_noise = qvi_envset(QVI_ENV_BARRIER_LOW_NOISE);
+        if (iparams.low_noise) {
+            iparams.spin = std::chrono::microseconds(0);
+            iparams.max_sleep = std::chrono::microseconds(
+                qvi_wait_params::low_noise_sleep_us
+            );
+        }
+        iparams.spin = env_microseconds(
+            QVI_ENV_BARRIER_SPIN_US, iparams.spin
+        );
+        iparams.max_sleep = env_microseconds(
+            QVI_ENV_BARRIER_MAX_SLEEP_US, iparams.max_sleep
+        );
+        return iparams;
+    }();
+    return params;
+}
+
 double
 qvi_time(void)
 {
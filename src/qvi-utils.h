@@ -42,6 +42,12 @@ public:
             delete this;
         }
     }
+    /** Returns the current number of references. */
+    int64_t
+    refcount(void) const
+    {
+        return refc.load();
+    }
 };
 
 /**
@@ -194,6 +200,52 @@ qvi_gettid(void)
     return gettid();
 }
 
+/**
+ * Parameters of waits that spin briefly, then sleep.
+ */
+struct qvi_wait_params {
+    /** Sleep between tests of a low-noise wait. */
+    static constexpr int64_t low_noise_sleep_us = 50000;
+    /** How long to test for completion without sleeping. */
+    std::chrono::microseconds spin = std::chrono::microseconds(100);
+    /** Longest sleep between tests. */
+    std::chrono::microseconds max_sleep = std::chrono::microseconds(10000);
+    /** Whether to only test sparingly, leaving the CPU to others. */
+    bool low_noise = false;
+};
+
+/**
+ * Returns the wait parameters set by QV_BARRIER_SPIN_US,
+ * QV_BARRIER_MAX_SLEEP_US, and QV_BARRIER_LOW_NOISE, which
+ * are read from the environment on first use.
+ */
+const qvi_wait_params &
+qvi_wait_params_env(void);
+
+/**
+ * Waits until the provided predicate holds. It is tested continuously for a
+ * short while, then between sleeps that double up to a maximum. In low-noise
+ * mode, every sleep is as long as the maximum.
+ */
+template <typename PRED>
+void
+qvi_wait_until(
+    PRED &&pred,
+    const qvi_wait_params &params = qvi_wait_params_env()
+) {
+    using namespace std::chrono;
+
+    const auto start = steady_clock::now();
+    microseconds sleep = params.low_noise ?
+        params.max_sleep : microseconds(1);
+    while (!pred()) {
+        if (steady_clock::now() - start < params.spin) continue;
+
+        std::this_thread::sleep_for(sleep);
+        sleep = std::min(2 * sleep, params.max_sleep);
+    }
+}
+
 /**
  *
  */
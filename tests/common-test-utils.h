@@ -266,6 +266,80 @@ ctu_change_bind(
     }
 }
 
+/**
+ * Exercises memory binding push/pop for each supported policy.
+ */
+static inline void
+ctu_change_membind(
+    qv_scope_t *scope
+) {
+    char const *ers = NULL;
+
+    const int pid = ctu_gettid();
+
+    const qv_membind_policy_t policies[] = {
+        QV_MEMBIND_BIND,
+        QV_MEMBIND_INTERLEAVE,
+        QV_MEMBIND_FIRSTTOUCH
+    };
+    const int npolicies = sizeof(policies) / sizeof(policies[0]);
+
+    for (int i = 0; i < npolicies; ++i) {
+        int rc = qv_scope_membind_push(scope, policies[i]);
+        // Some environments (e.g., containers) disallow memory binding.
+        if (rc == QV_ERR_NOT_SUPPORTED) {
+            printf("[%d] Memory binding is not supported\n", pid);
+            return;
+        }
+        if (rc != QV_SUCCESS) {
+            ers = "qv_scope_membind_push() failed";
+            ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
+        }
+        rc = qv_scope_membind_pop(scope);
+        if (rc != QV_SUCCESS) {
+            ers = "qv_scope_membind_pop() failed";
+            ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
+        }
+    }
+    printf("[%d] Memory binding push/pop succeeded\n", pid);
+}
+
+/**
+ * Exercises scope-local memory allocation across small and large sizes.
+ */
+static inline void
+ctu_scope_malloc(
+    qv_scope_t *scope
+) {
+    char const *ers = NULL;
+
+    const int pid = ctu_gettid();
+
+    const size_t sizes[] = {0, 1, 64, 4096, 100000, 8 * 1024 * 1024};
+    const int nsizes = sizeof(sizes) / sizeof(sizes[0]);
+
+    for (int i = 0; i < nsizes; ++i) {
+        void *ptr = NULL;
+        int rc = qv_scope_malloc(scope, sizes[i], QV_SCOPE_MALLOC_NONE, &ptr);
+        // Some environments (e.g., containers) disallow memory binding.
+        if (rc == QV_ERR_NOT_SUPPORTED) {
+            printf("[%d] Scope memory allocation is not supported\n", pid);
+            return;
+        }
+        if (rc != QV_SUCCESS) {
+            ers = "qv_scope_malloc() failed";
+            ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
+        }
+        memset(ptr, 0xa5, sizes[i]);
+        rc = qv_scope_mfree(scope, ptr);
+        if (rc != QV_SUCCESS) {
+            ers = "qv_scope_mfree() failed";
+            ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
+        }
+    }
+    printf("[%d] Scope memory allocation succeeded\n", pid);
+}
+
 #endif // #ifdef QUO_VADIS
 
 // We assume that the infrastructure-specific headers are included before us.
@@ -36,7 +36,9 @@ static const hw_name_type_t nts[] = {
     {CTU_TOSTRING(QV_HW_OBJ_L3CACHE),  QV_HW_OBJ_L3CACHE},
     {CTU_TOSTRING(QV_HW_OBJ_L4CACHE),  QV_HW_OBJ_L4CACHE},
     {CTU_TOSTRING(QV_HW_OBJ_L5CACHE),  QV_HW_OBJ_L5CACHE},
-    {CTU_TOSTRING(QV_HW_OBJ_NUMANODE), QV_HW_OBJ_NUMANODE}
+    {CTU_TOSTRING(QV_HW_OBJ_NUMANODE), QV_HW_OBJ_NUMANODE},
+    {CTU_TOSTRING(QV_HW_OBJ_DIE),      QV_HW_OBJ_DIE},
+    {CTU_TOSTRING(QV_HW_OBJ_GROUP),    QV_HW_OBJ_GROUP}
 };
 
 typedef struct device_name_type_s {
@@ -114,29 +116,41 @@ echo_task_intersections(
     return QV_SUCCESS;
 }
 
+typedef struct distance_name_kind_s {
+    char const *name;
+    qv_hw_distance_kind_t kind;
+} distance_name_kind_t;
+
+static const distance_name_kind_t distnks[] = {
+    {CTU_TOSTRING(QV_HW_DISTANCE_LATENCY),   QV_HW_DISTANCE_LATENCY},
+    {CTU_TOSTRING(QV_HW_DISTANCE_BANDWIDTH), QV_HW_DISTANCE_BANDWIDTH}
+};
+
 static int
-echo_gpu_info(
-    qvi_hwloc &hwl
+echo_device_info(
+    qvi_hwloc &hwl,
+    qv_hw_obj_type_t dev_type,
+    const char *dev_name
 ) {
-    printf("\n# Discovered GPU Devices --------------\n");
+    printf("\n# Discovered %s Devices --------------\n", dev_name);
 
-    int ngpus = 0;
+    int ndevs = 0;
     int rc = hwl.get_nobjs_in_cpuset(
-        QV_HW_OBJ_GPU, hwl.topology_get_cpuset(), &ngpus
+        dev_type, hwl.topology_get_cpuset(), &ndevs
     );
     if (rc != QV_SUCCESS) return rc;
 
-    printf("# Number of GPUs: %u\n", ngpus);
+    printf("# Number of %ss: %u\n", dev_name, ndevs);
 
-    rc = hwl.devices_emit(QV_HW_OBJ_GPU);
+    rc = hwl.devices_emit(dev_type);
     if (rc != QV_SUCCESS) return rc;
 
     const unsigned ndevids = sizeof(devnts) / sizeof(device_name_type_t);
-    for (int i = 0; i < ngpus; ++i) {
+    for (int i = 0; i < ndevs; ++i) {
         for (unsigned j = 0; j < ndevids; ++j) {
             std::string devids;
             rc = hwl.get_device_id_in_cpuset(
-                QV_HW_OBJ_GPU, i,
+                dev_type, i,
                 hwl.topology_get_cpuset(),
                 devnts[j].type, devids
             );
@@ -149,17 +163,351 @@ echo_gpu_info(
     return rc;
 }
 
+static int
+echo_numa_distances(
+    qvi_hwloc &hwl
+) {
+    printf("\n# NUMA Distances ----------------------\n");
+
+    const unsigned ndistnks = sizeof(distnks) / sizeof(distance_name_kind_t);
+    for (unsigned k = 0; k < ndistnks; ++k) {
+        qvi_hwloc_distances dists;
+        const int rc = hwl.get_numa_distances(
+            hwl.topology_get_cpuset(), distnks[k].kind, dists
+        );
+        if (rc != QV_SUCCESS) return rc;
+
+        printf("# %s (%u nodes)\n", distnks[k].name, dists.nnodes);
+        for (unsigned i = 0; i < dists.nnodes; ++i) {
+            printf("#");
+            for (unsigned j = 0; j < dists.nnodes; ++j) {
+                printf(" %" PRIu64, dists.values[i * dists.nnodes + j]);
+            }
+            printf("\n");
+        }
+    }
+
+    printf("# -------------------------------------\n");
+    return QV_SUCCESS;
+}
+
+static int
+echo_numa_nodes(
+    qvi_hwloc &hwl
+) {
+    printf("\n# NUMA Nodes --------------------------\n");
+
+    qvi_hwloc_numa_nodes nodes;
+    const int rc = hwl.get_numa_nodes_in_cpuset(
+        hwl.topology_get_cpuset(), nodes
+    );
+    if (rc != QV_SUCCESS) return rc;
+
+    for (const auto &node : nodes) {
+        printf(
+            "# Node %u subtype=%s capacity=%" PRIu64
+            " bandwidth=%" PRIu64 " latency=%" PRIu64 "\n",
+            node.os_index,
+            node.subtype.empty() ? "-" : node.subtype.c_str(),
+            node.capacity, node.bandwidth, node.latency
+        );
+    }
+
+    printf("# -------------------------------------\n");
+    return QV_SUCCESS;
+}
+
+static int
+echo_numa_domains(
+    qvi_hwloc &hwl
+) {
+    printf("\n# NUMA Domains ------------------------\n");
+
+    qvi_hwloc_bitmaps domains;
+    int rc = hwl.get_numa_domain_cpusets_in_cpuset(
+        hwl.topology_get_cpuset(), domains
+    );
+    if (rc != QV_SUCCESS) return rc;
+
+    for (uint_t i = 0; i < domains.size(); ++i) {
+        qvi_hwloc_numa_nodes nodes;
+        rc = hwl.get_numa_nodes_in_cpuset(domains[i].cdata(), nodes);
+        if (rc != QV_SUCCESS) return rc;
+        // Each domain carries the memory tiers local to its CPUs.
+        std::string tiers;
+        for (const auto &node : nodes) {
+            if (!tiers.empty()) tiers += ",";
+            tiers += std::to_string(node.os_index) + ":" +
+                (node.subtype.empty() ? "-" : node.subtype);
+        }
+        printf(
+            "# NUMA domain %u cpuset=%s nodes=%s\n", i,
+            qvi_hwloc::bitmap_string(domains[i].cdata()).c_str(),
+            tiers.c_str()
+        );
+    }
+
+    printf("# -------------------------------------\n");
+    return QV_SUCCESS;
+}
+
+static int
+echo_cache_capacity_cpusets(
+    qvi_hwloc &hwl
+) {
+    printf("\n# Cache Capacity cpusets --------------\n");
+
+    const uint64_t nbytes[] = {0, 1 << 20, 40 << 20, 1ULL << 40};
+    const unsigned nnbytes = sizeof(nbytes) / sizeof(uint64_t);
+    for (unsigned i = 0; i < nnbytes; ++i) {
+        qvi_hwloc_bitmap cpuset;
+        const int rc = hwl.get_cpuset_for_cache_capacity(
+            hwl.topology_get_cpuset(), nbytes[i], cpuset
+        );
+        if (rc == QV_RES_UNAVAILABLE) {
+            printf("# %" PRIu64 " bytes: unavailable\n", nbytes[i]);
+            continue;
+        }
+        if (rc != QV_SUCCESS) return rc;
+        printf(
+            "# %" PRIu64 " bytes: cpuset=%s\n", nbytes[i],
+            qvi_hwloc::bitmap_string(cpuset.cdata()).c_str()
+        );
+    }
+
+    printf("# -------------------------------------\n");
+    return QV_SUCCESS;
+}
+
+static int
+echo_cpukinds(
+    qvi_hwloc &hwl
+) {
+    printf("\n# CPU Kinds ---------------------------\n");
+
+    qvi_hwloc_cpukinds kinds;
+    int rc = hwl.get_cpukinds_in_cpuset(hwl.topology_get_cpuset(), kinds);
+    if (rc != QV_SUCCESS) return rc;
+
+    for (uint_t i = 0; i < kinds.size(); ++i) {
+        printf(
+            "# Kind %u efficiency=%d core_type=%s cpuset=%s\n", i,
+            kinds[i].efficiency,
+            kinds[i].core_type.empty() ? "-" : kinds[i].core_type.c_str(),
+            qvi_hwloc::bitmap_string(kinds[i].cpuset.cdata()).c_str()
+        );
+    }
+
+    const qvi_hwloc_bitmap all(hwl.topology_get_cpuset());
+    qvi_hwloc_bitmap perf, eff;
+    rc = hwl.bitmap_restrict_to_cpukind(all, true, perf);
+    if (rc != QV_SUCCESS) return rc;
+    rc = hwl.bitmap_restrict_to_cpukind(all, false, eff);
+    if (rc != QV_SUCCESS) return rc;
+    printf(
+        "# Performance cores=%s Efficiency cores=%s\n",
+        qvi_hwloc::bitmap_string(perf.cdata()).c_str(),
+        qvi_hwloc::bitmap_string(eff.cdata()).c_str()
+    );
+
+    printf("# -------------------------------------\n");
+    return QV_SUCCESS;
+}
+
+/**
+ * Returns the number of pieces that straddle a boundary between objects of
+ * the provided type: pieces that intersect more than one such object without
+ * containing all of them.
+ */
+static int
+count_crossings(
+    qvi_hwloc &hwl,
+    const qvi_hwloc_bitmaps &pieces,
+    qv_hw_obj_type_t type
+) {
+    qvi_hwloc_bitmaps all_objs, objs;
+    const int rc = hwl.get_obj_cpusets_in_cpuset(
+        type, hwl.topology_get_cpuset(), all_objs
+    );
+    if (rc != QV_SUCCESS) return -1;
+    // Objects sharing a cpuset (e.g., DRAM and HBM NUMA nodes) do not
+    // introduce a boundary between them.
+    for (const auto &obj : all_objs) {
+        bool dup = false;
+        for (const auto &uobj : objs) {
+            if (hwloc_bitmap_isequal(obj.cdata(), uobj.cdata())) dup = true;
+        }
+        if (!dup) objs.push_back(obj);
+    }
+
+    int ncrossings = 0;
+    for (const auto &piece : pieces) {
+        int nobjs = 0;
+        bool partial = false;
+        for (const auto &obj : objs) {
+            if (!hwloc_bitmap_intersects(piece.cdata(), obj.cdata())) continue;
+            nobjs++;
+            if (!hwloc_bitmap_isincluded(obj.cdata(), piece.cdata())) {
+                partial = true;
+            }
+        }
+        if (nobjs > 1 && partial) ncrossings++;
+    }
+    return ncrossings;
+}
+
+static int
+echo_hierarchical_splits(
+    qvi_hwloc &hwl
+) {
+    printf("\n# Boundary Crossings ------------------\n");
+
+    static const qv_hw_obj_type_t types[] = {
+        QV_HW_OBJ_PACKAGE, QV_HW_OBJ_NUMANODE, QV_HW_OBJ_L3CACHE
+    };
+    hwloc_const_cpuset_t cpuset = hwl.topology_get_cpuset();
+    const int npus = hwloc_bitmap_weight(cpuset);
+    for (const uint_t npieces : {2u, 3u, 6u}) {
+        if (int(npieces) > npus) continue;
+        qvi_hwloc_bitmaps chunked(npieces), hierarchical;
+        for (uint_t i = 0; i < npieces; ++i) {
+            const int rc = hwl.bitmap_split_by_chunk_id(
+                cpuset, npieces, i, chunked[i].data()
+            );
+            if (rc != QV_SUCCESS) return rc;
+        }
+        const int rc = hwl.bitmap_split_hierarchical(
+            cpuset, npieces, hierarchical
+        );
+        if (rc != QV_SUCCESS) return rc;
+
+        int crossings[2] = {0, 0};
+        for (const auto type : types) {
+            crossings[0] += count_crossings(hwl, chunked, type);
+            crossings[1] += count_crossings(hwl, hierarchical, type);
+        }
+        int minsize = npus, maxsize = 0;
+        for (const auto &piece : hierarchical) {
+            const int size = hwloc_bitmap_weight(piece.cdata());
+            minsize = std::min(minsize, size);
+            maxsize = std::max(maxsize, size);
+        }
+        printf(
+            "# %u pieces: chunked crossings=%d hierarchical crossings=%d "
+            "sizes=%d..%d\n",
+            npieces, crossings[0], crossings[1], minsize, maxsize
+        );
+        for (uint_t i = 0; i < npieces; ++i) {
+            printf(
+                "#   piece %u chunked=%s hierarchical=%s\n", i,
+                qvi_hwloc::bitmap_string(chunked[i].cdata()).c_str(),
+                qvi_hwloc::bitmap_string(hierarchical[i].cdata()).c_str()
+            );
+        }
+    }
+
+    printf("# -------------------------------------\n");
+    return QV_SUCCESS;
+}
+
+/**
+ * Clients load a lean topology while the server loads a full one, and the two
+ * exchange logical indices, so lookups must agree between them.
+ */
+static int
+echo_lean_agreement(
+    qvi_hwloc &hwl,
+    const std::string &synthetic
+) {
+    printf("\n# Lean Topology -----------------------\n");
+
+    qvi_hwloc lean;
+    int rc = lean.topology_init("", synthetic);
+    if (rc != QV_SUCCESS) return rc;
+    rc = lean.topology_load(true);
+    if (rc != QV_SUCCESS) return rc;
+
+    const std::string full_cpuset = qvi_hwloc::bitmap_string(
+        hwl.topology_get_cpuset()
+    );
+    const std::string lean_cpuset = qvi_hwloc::bitmap_string(
+        lean.topology_get_cpuset()
+    );
+    printf("# allowed cpuset full=%s lean=%s\n",
+        full_cpuset.c_str(), lean_cpuset.c_str()
+    );
+    if (full_cpuset != lean_cpuset) return QV_ERR_INTERNAL;
+
+    hwloc_const_cpuset_t cpuset = hwl.topology_get_cpuset();
+    const hwloc_obj_type_t types[] = {
+        HWLOC_OBJ_PACKAGE, HWLOC_OBJ_NUMANODE, HWLOC_OBJ_CORE, HWLOC_OBJ_PU
+    };
+    qvi_hwloc_bitmap pu;
+    int pu_index = -1;
+    hwloc_bitmap_foreach_begin(pu_index, cpuset) {
+        if (hwloc_bitmap_only(pu.data(), pu_index) != 0) {
+            return QV_ERR_HWLOC;
+        }
+
+        for (const auto type : types) {
+            const int full_index = hwl.get_obj_index_of_first_pu(
+                pu.cdata(), type
+            );
+            const int lean_index = lean.get_obj_index_of_first_pu(
+                pu.cdata(), type
+            );
+            if (full_index != lean_index) {
+                printf("# PU os=%d %s full=%d lean=%d\n", pu_index,
+                    hwloc_obj_type_string(type), full_index, lean_index
+                );
+                return QV_ERR_INTERNAL;
+            }
+        }
+
+        int full_numa = -1, lean_numa = -1;
+        rc = hwl.get_numa_index_in_cpuset(cpuset, pu.cdata(), &full_numa);
+        if (rc != QV_SUCCESS) return rc;
+        rc = lean.get_numa_index_in_cpuset(cpuset, pu.cdata(), &lean_numa);
+        if (rc != QV_SUCCESS) return rc;
+        if (full_numa != lean_numa) {
+            printf("# PU os=%d NUMA index full=%d lean=%d\n",
+                pu_index, full_numa, lean_numa
+            );
+            return QV_ERR_INTERNAL;
+        }
+    } hwloc_bitmap_foreach_end();
+
+    qvi_hwloc_distances full_dists, lean_dists;
+    rc = hwl.get_numa_distances(cpuset, QV_HW_DISTANCE_LATENCY, full_dists);
+    if (rc != QV_SUCCESS) return rc;
+    rc = lean.get_numa_distances(cpuset, QV_HW_DISTANCE_LATENCY, lean_dists);
+    if (rc != QV_SUCCESS) return rc;
+    if (full_dists.nnodes != lean_dists.nnodes ||
+        full_dists.values != lean_dists.values) {
+        printf("# NUMA distances disagree\n");
+        return QV_ERR_INTERNAL;
+    }
+
+    printf("# Lean topology lookups agree\n");
+    printf("# -------------------------------------\n");
+    return QV_SUCCESS;
+}
+
 int
-main(void)
-{
+main(
+    int argc,
+    char **argv
+) {
     printf("\n# Starting hwloc test\n");
+    // An optional hwloc synthetic topology description.
+    const std::string synthetic = (argc > 1 ? argv[1] : "");
 
     char const *ers = nullptr;
     qvi_hwloc hwl;
     qvi_hwloc_bitmap bitmap;
     pid_t who = qvi_gettid();
 
-    int rc = hwl.topology_init();
+    int rc = hwl.topology_init("", synthetic);
     if (rc != QV_SUCCESS) {
         ers = "qvi_hwloc_topology_init() failed";
         ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
@@ -177,9 +525,57 @@ main(void)
         ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
     }
 
-    rc = echo_gpu_info(hwl);
+    rc = echo_device_info(hwl, QV_HW_OBJ_GPU, "GPU");
+    if (rc != QV_SUCCESS) {
+        ers = "echo_device_info(GPU) failed";
+        ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
+    }
+
+    rc = echo_device_info(hwl, QV_HW_OBJ_NIC, "NIC");
+    if (rc != QV_SUCCESS) {
+        ers = "echo_device_info(NIC) failed";
+        ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
+    }
+
+    rc = echo_numa_distances(hwl);
+    if (rc != QV_SUCCESS) {
+        ers = "echo_numa_distances() failed";
+        ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
+    }
+
+    rc = echo_numa_nodes(hwl);
+    if (rc != QV_SUCCESS) {
+        ers = "echo_numa_nodes() failed";
+        ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
+    }
+
+    rc = echo_numa_domains(hwl);
+    if (rc != QV_SUCCESS) {
+        ers = "echo_numa_domains() failed";
+        ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
+    }
+
+    rc = echo_cache_capacity_cpusets(hwl);
+    if (rc != QV_SUCCESS) {
+        ers = "echo_cache_capacity_cpusets() failed";
+        ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
+    }
+
+    rc = echo_cpukinds(hwl);
+    if (rc != QV_SUCCESS) {
+        ers = "echo_cpukinds() failed";
+        ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
+    }
+
+    rc = echo_hierarchical_splits(hwl);
+    if (rc != QV_SUCCESS) {
+        ers = "echo_hierarchical_splits() failed";
+        ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
+    }
+
+    rc = echo_lean_agreement(hwl, synthetic);
     if (rc != QV_SUCCESS) {
-        ers = "echo_gpu_info() failed";
+        ers = "echo_lean_agreement() failed";
         ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
     }
 
@@ -0,0 +1,272 @@
+/* -*- Mode: C; c-basic-offset:4; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2025      Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the quo-vadis project. See the LICENSE file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * @file test-map.cc
+ */
+
+#include "qvi-common.h" // IWYU pragma: keep
+#include "qvi-map.h"
+#include "qvi-utils.h"
+
+#include "quo-vadis.h"
+#include "common-test-utils.h"
+
+/** Returns a bitmap with the inclusive PU range [first, last] set. */
+static qvi_hwloc_bitmap
+make_range(
+    int first,
+    int last
+) {
+    qvi_hwloc_bitmap result;
+    hwloc_bitmap_set_range(result.data(), first, last);
+    return result;
+}
+
+/** Returns nres resources of npur PUs each. */
+static qvi_hwloc_bitmaps
+make_resources(
+    int nres,
+    int npur
+) {
+    qvi_hwloc_bitmaps result;
+    for (int i = 0; i < nres; ++i) {
+        result.push_back(make_range(i * npur, (i + 1) * npur - 1));
+    }
+    return result;
+}
+
+static void
+expect_mapping(
+    const char *what,
+    const qvi_map_t &map,
+    const std::vector<uint_t> &expected
+) {
+    std::vector<uint_t> got;
+    const int rc = qvi_map_flatten(map, got);
+    if (rc != QV_SUCCESS) ctu_panic("%s: rc=%s", what, qv_strerr(rc));
+    printf("# %s:", what);
+    for (const auto tid : got) printf(" %u", tid);
+    printf("\n");
+    if (got != expected) {
+        ctu_panic("%s: unexpected mapping", what);
+    }
+}
+
+static void
+check_mappings(void)
+{
+    const qvi_hwloc_bitmaps tres = make_resources(4, 4);
+    // Disjoint affinities stay with the resource they are bound to.
+    {
+        qvi_hwloc_bitmaps faffs;
+        for (const int pu : {15, 0, 4, 9, 1, 12, 8, 5}) {
+            faffs.push_back(make_range(pu, pu));
+        }
+        qvi_map_t map;
+        int rc = qvi_map_affinity_preserving(map, qvi_map_packed, faffs, tres);
+        if (rc != QV_SUCCESS) ctu_panic("disjoint: rc=%s", qv_strerr(rc));
+        expect_mapping("disjoint", map, {3, 0, 1, 2, 0, 3, 2, 1});
+    }
+    // Fully shared affinities are spread round robin across the resources.
+    {
+        qvi_hwloc_bitmaps faffs(8, make_range(0, 15));
+        qvi_map_t map;
+        int rc = qvi_map_affinity_preserving(map, qvi_map_packed, faffs, tres);
+        if (rc != QV_SUCCESS) ctu_panic("shared: rc=%s", qv_strerr(rc));
+        expect_mapping("shared", map, {0, 0, 1, 1, 2, 2, 3, 3});
+    }
+    // The greedy mapper hands a task that straddles two resources to the first
+    // one, while the optimal mapper picks the one it overlaps most.
+    {
+        const qvi_hwloc_bitmaps tres2 = make_resources(2, 4);
+        qvi_hwloc_bitmaps faffs = {
+            make_range(3, 7), make_range(0, 0), make_range(4, 4)
+        };
+        qvi_map_t greedy, optimal;
+        int rc = qvi_map_affinity_preserving(
+            greedy, qvi_map_packed, faffs, tres2
+        );
+        if (rc != QV_SUCCESS) ctu_panic("greedy: rc=%s", qv_strerr(rc));
+        rc = qvi_map_affinity_optimal(optimal, faffs, tres2);
+        if (rc != QV_SUCCESS) ctu_panic("optimal: rc=%s", qv_strerr(rc));
+        expect_mapping("greedy", greedy, {0, 0, 1});
+        expect_mapping("optimal", optimal, {1, 0, 1});
+        const uint64_t gov = qvi_map_overlap(greedy, faffs, tres2);
+        const uint64_t oov = qvi_map_overlap(optimal, faffs, tres2);
+        printf("# overlap: greedy=%" PRIu64 " optimal=%" PRIu64 "\n", gov, oov);
+        if (gov != 3 || oov != 6) ctu_panic("unexpected overlap");
+    }
+    // Unbound consumers have infinite affinities, which both mappers handle.
+    {
+        qvi_hwloc_bitmap full;
+        hwloc_bitmap_fill(full.data());
+        const qvi_hwloc_bitmaps faffs(8, full);
+        qvi_map_t greedy, optimal;
+        int rc = qvi_map_affinity_preserving(
+            greedy, qvi_map_packed, faffs, tres
+        );
+        if (rc != QV_SUCCESS) ctu_panic("infinite: rc=%s", qv_strerr(rc));
+        rc = qvi_map_affinity_optimal(optimal, faffs, tres);
+        if (rc != QV_SUCCESS) ctu_panic("infinite: rc=%s", qv_strerr(rc));
+        expect_mapping("infinite greedy", greedy, {0, 0, 1, 1, 2, 2, 3, 3});
+        expect_mapping("infinite optimal", optimal, {0, 0, 1, 1, 2, 2, 3, 3});
+    }
+    // Colors map to resources in color order.
+    {
+        qvi_map_t map;
+        int rc = qvi_map_colors(map, {3, 5, 3, 4}, tres);
+        if (rc != QV_SUCCESS) ctu_panic("colors: rc=%s", qv_strerr(rc));
+        expect_mapping("colors", map, {0, 2, 0, 1});
+    }
+}
+
+/**
+ * Maps GPUs local to the two NUMA nodes of a synthetic topology to pieces of
+ * it. Devices must stay with pieces local to them whenever there is room.
+ */
+static void
+check_device_mappings(void)
+{
+    qvi_hwloc hwl;
+    int rc = hwl.topology_init("", "pack:2 numa:1 core:4 pu:1");
+    if (rc == QV_SUCCESS) rc = hwl.topology_load();
+    if (rc != QV_SUCCESS) ctu_panic("devices: rc=%s", qv_strerr(rc));
+
+    hwloc_const_cpuset_t cpuset = hwl.topology_get_cpuset();
+    qvi_hwloc_bitmaps numas, quarters, halves;
+    rc = hwl.get_obj_cpusets_in_cpuset(QV_HW_OBJ_NUMANODE, cpuset, numas);
+    if (rc == QV_SUCCESS) {
+        rc = hwl.bitmap_split_hierarchical(cpuset, 4, quarters);
+    }
+    if (rc == QV_SUCCESS) {
+        rc = hwl.bitmap_split_hierarchical(cpuset, 2, halves);
+    }
+    if (rc != QV_SUCCESS || numas.size() != 2) {
+        ctu_panic("devices: bad topology (rc=%s)", qv_strerr(rc));
+    }
+    const auto map_devices = [](
+        const char *what,
+        const qvi_hwloc_bitmaps &devaffs,
+        const qvi_hwloc_bitmaps &pieces,
+        bool balanced,
+        const std::vector<uint_t> &expected
+    ) {
+        qvi_map_t map;
+        const int rc = qvi_map_devices(map, devaffs, pieces, balanced);
+        if (rc != QV_SUCCESS) ctu_panic("%s: rc=%s", what, qv_strerr(rc));
+        expect_mapping(what, map, expected);
+    };
+    // Two GPUs per NUMA node, in the interleaved order spread uses.
+    const qvi_hwloc_bitmaps even = {numas[0], numas[1], numas[0], numas[1]};
+    map_devices("gpus packed", even, quarters, false, {0, 2, 1, 3});
+    map_devices("gpus spread", even, quarters, true, {0, 2, 1, 3});
+    // Four GPUs on the first node and two on the second: only spread hands
+    // the first node's extra GPUs to the second node's piece.
+    const qvi_hwloc_bitmaps uneven = {
+        numas[0], numas[1], numas[0], numas[1], numas[0], numas[0]
+    };
+    map_devices("uneven packed", uneven, halves, false, {0, 1, 0, 1, 0, 0});
+    map_devices("uneven spread", uneven, halves, true, {0, 1, 0, 1, 0, 1});
+    // Pieces listed in the opposite order from the NUMA nodes still get their
+    // local GPUs.
+    const qvi_hwloc_bitmaps reversed = {halves[1], halves[0]};
+    map_devices("reversed spread", even, reversed, true, {1, 0, 1, 0});
+}
+
+static void
+time_mappings(void)
+{
+    // 256 resources of 8 PUs each.
+    const int npus = 2048;
+    const qvi_hwloc_bitmaps tres = make_resources(npus / 8, 8);
+
+    printf("\n# Affinity-preserving mapping times (%zu resources)\n", tres.size());
+    for (int ncon = 16; ncon <= 65536; ncon *= 4) {
+        // Consumers bound to single PUs, and unbound consumers.
+        qvi_hwloc_bitmaps bound, unbound(ncon, make_range(0, npus - 1));
+        for (int i = 0; i < ncon; ++i) {
+            const int pu = (i * 7) % npus;
+            bound.push_back(make_range(pu, pu));
+        }
+        for (const auto *faffs : {&bound, &unbound}) {
+            qvi_map_t map;
+            const double start = qvi_time();
+            int rc = qvi_map_affinity_preserving(
+                map, qvi_map_packed, *faffs, tres
+            );
+            const double end = qvi_time();
+            if (rc != QV_SUCCESS || qvi_map_nfids_mapped(map) != uint_t(ncon)) {
+                ctu_panic("timing: mapping failed (rc=%s)", qv_strerr(rc));
+            }
+            printf("# nconsumers=%d %s %.3lf ms\n", ncon,
+                (faffs == &bound ? "bound" : "unbound"), (end - start) * 1e3
+            );
+        }
+    }
+}
+
+/**
+ * Compares greedy and optimal mappings of tasks whose affinities straddle
+ * resource boundaries.
+ */
+static void
+compare_mappings(void)
+{
+    // 64 resources of 8 PUs each.
+    const int npus = 512;
+    const qvi_hwloc_bitmaps tres = make_resources(npus / 8, 8);
+    std::mt19937 gen(42);
+
+    printf("\n# Greedy versus optimal mapping (%zu resources)\n", tres.size());
+    for (int ncon = 16; ncon <= 4096; ncon *= 4) {
+        qvi_hwloc_bitmaps faffs;
+        for (int i = 0; i < ncon; ++i) {
+            const int first = gen() % npus;
+            const int last = std::min(npus - 1, first + int(gen() % 12));
+            faffs.push_back(make_range(first, last));
+        }
+        qvi_map_t greedy, optimal;
+        const double start = qvi_time();
+        int rc = qvi_map_affinity_preserving(
+            greedy, qvi_map_packed, faffs, tres
+        );
+        const double middle = qvi_time();
+        if (rc == QV_SUCCESS) {
+            rc = qvi_map_affinity_optimal(optimal, faffs, tres);
+        }
+        const double end = qvi_time();
+        if (rc != QV_SUCCESS ||
+            qvi_map_nfids_mapped(optimal) != uint_t(ncon)) {
+            ctu_panic("compare: mapping failed (rc=%s)", qv_strerr(rc));
+        }
+        printf(
+            "# nconsumers=%d overlap greedy=%" PRIu64 " (%.3lf ms)"
+            " optimal=%" PRIu64 " (%.3lf ms)\n", ncon,
+            qvi_map_overlap(greedy, faffs, tres), (middle - start) * 1e3,
+            qvi_map_overlap(optimal, faffs, tres), (end - middle) * 1e3
+        );
+    }
+}
+
+int
+main(void)
+{
+    printf("\n# Starting map test\n");
+    check_mappings();
+    check_device_mappings();
+    compare_mappings();
+    time_mappings();
+    printf("# Done\n");
+    return EXIT_SUCCESS;
+}
+
+/*
+ * vim: ft=cpp ts=4 sts=4 sw=4 expandtab
+ */
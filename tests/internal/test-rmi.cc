@@ -46,6 +46,12 @@ server(
         ers = "server.configure() failed";
         goto out;
     }
+    // The loaded topology cannot be replaced.
+    rc = server.configure(config);
+    if (rc != QV_ERR_INVLD_ARG) {
+        ers = "second server.configure() did not fail";
+        goto out;
+    }
 
     rc = server.start();
     if (rc != QV_SUCCESS) {
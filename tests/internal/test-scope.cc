@@ -0,0 +1,246 @@
+/* -*- Mode: C++; c-basic-offset:4; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2025      Triad National Security, LLC
+ *                         All rights reserved.
+ *
+ * This file is part of the quo-vadis project. See the LICENSE file at the
+ * top-level directory of this distribution.
+ */
+
+/**
+ * @file test-scope.cc
+ */
+
+#include "qvi-common.h" // IWYU pragma: keep
+#include "qvi-scope.h"
+
+#include "quo-vadis.h"
+#include "quo-vadis-thread.h"
+#include "common-test-utils.h"
+
+static qv_scope_t *
+split(
+    qv_scope_t *scope,
+    int color
+) {
+    qv_scope_t *child = nullptr;
+    const int rc = qv_scope_split(scope, 1, color, &child);
+    if (rc != QV_SUCCESS) {
+        ctu_panic("qv_scope_split() failed (rc=%s)", qv_strerr(rc));
+    }
+    return child;
+}
+
+static void
+scope_free(
+    qv_scope_t *scope
+) {
+    const int rc = qv_scope_free(scope);
+    if (rc != QV_SUCCESS) {
+        ctu_panic("qv_scope_free() failed (rc=%s)", qv_strerr(rc));
+    }
+}
+
+static void
+expect_refc(
+    const char *what,
+    const qvi_group &group,
+    int64_t expected
+) {
+    const int64_t refc = group.refcount();
+    printf("# %s: refc=%" PRId64 "\n", what, refc);
+    if (refc != expected) {
+        ctu_panic("%s: refc=%" PRId64 ", expected %" PRId64,
+            what, refc, expected
+        );
+    }
+}
+
+/**
+ * Repeated identical splits are served from the memo, so their subscopes
+ * share a group that must outlive each of them.
+ */
+static void
+check_split_memo(
+    qv_scope_t *base
+) {
+    qv_scope_t *first = split(base, QV_SCOPE_SPLIT_PACKED);
+    qvi_group &group = first->group();
+    // Held by the subscope and the memo.
+    expect_refc("first split", group, 2);
+
+    qv_scope_t *again = split(base, QV_SCOPE_SPLIT_PACKED);
+    if (&again->group() != &group) {
+        ctu_panic("repeated split was not served from the memo");
+    }
+    expect_refc("memoized split", group, 3);
+    // A different split must not match.
+    qv_scope_t *other = split(base, QV_SCOPE_SPLIT_SPREAD);
+    if (&other->group() == &group) {
+        ctu_panic("different split was served from the memo");
+    }
+    scope_free(other);
+    // Freeing one sharer leaves the group to the other and the memo.
+    scope_free(first);
+    expect_refc("first freed", group, 2);
+    if (again->group_size() != 1 || again->group_barrier() != QV_SUCCESS) {
+        ctu_panic("memoized subscope unusable after its sharer was freed");
+    }
+    scope_free(again);
+    expect_refc("both freed", group, 1);
+    // The memo keeps serving the group.
+    qv_scope_t *last = split(base, QV_SCOPE_SPLIT_PACKED);
+    if (&last->group() != &group) {
+        ctu_panic("memoized group was not retained");
+    }
+    expect_refc("split after free", group, 2);
+    scope_free(last);
+}
+
+/**
+ * Memory allocated through a scope must land on the scope's NUMA nodes.
+ */
+static void
+check_malloc_placement(
+    qv_scope_t *scope
+) {
+    const size_t size = 8 * 1024 * 1024;
+    void *ptr = nullptr;
+    int rc = qv_scope_malloc(scope, size, QV_SCOPE_MALLOC_NONE, &ptr);
+    // Some environments (e.g., containers) disallow memory binding.
+    if (rc == QV_ERR_NOT_SUPPORTED) {
+        printf("# Scope memory allocation is not supported\n");
+        return;
+    }
+    if (rc != QV_SUCCESS) {
+        ctu_panic("qv_scope_malloc() failed (rc=%s)", qv_strerr(rc));
+    }
+    // Place the pages.
+    memset(ptr, 0xa5, size);
+
+    qvi_hwloc_bitmap expected;
+    rc = scope->hwpool().mem_nodeset(expected);
+    if (rc != QV_SUCCESS) {
+        ctu_panic("mem_nodeset() failed (rc=%s)", qv_strerr(rc));
+    }
+    qvi_hwloc_bitmap actual;
+    const int hrc = hwloc_get_area_memlocation(
+        scope->group().hwloc().topology_get(), ptr, size,
+        actual.data(), HWLOC_MEMBIND_BYNODESET
+    );
+    if (hrc != 0) {
+        printf("# Memory location queries are not supported\n");
+    }
+    else {
+        const std::string as = qvi_hwloc::bitmap_list_string(actual.cdata());
+        const std::string es = qvi_hwloc::bitmap_list_string(expected.cdata());
+        printf(
+            "# Memory on NUMA nodes %s, scope has %s\n", as.c_str(), es.c_str()
+        );
+        if (hwloc_bitmap_iszero(actual.cdata()) ||
+            !hwloc_bitmap_isincluded(actual.cdata(), expected.cdata())) {
+            ctu_panic("memory is on NUMA nodes %s, expected within %s",
+                as.c_str(), es.c_str()
+            );
+        }
+    }
+    rc = qv_scope_mfree(scope, ptr);
+    if (rc != QV_SUCCESS) {
+        ctu_panic("qv_scope_mfree() failed (rc=%s)", qv_strerr(rc));
+    }
+}
+
+/**
+ * Measures the throughput of qv_scope_bind_push() and qv_scope_bind_pop()
+ * when many threads push and pop their own thread scopes' bindings at once.
+ */
+static void
+bench_thread_bind_push(
+    qv_scope_t *scope
+) {
+    static constexpr int nthreads = 64;
+    static constexpr int npairs = 100;
+
+    std::vector<int> colors(nthreads, 0);
+    qv_scope_t **thscopes = nullptr;
+    int rc = qv_thread_scope_split(
+        scope, 1, colors.data(), nthreads, &thscopes
+    );
+    if (rc != QV_SUCCESS) {
+        ctu_panic("qv_thread_scope_split() failed (rc=%s)", qv_strerr(rc));
+    }
+
+    std::atomic<int> nfailed(0);
+    std::vector<std::thread> threads;
+    const double start = qvi_time();
+    for (int i = 0; i < nthreads; ++i) {
+        threads.emplace_back([&, i] {
+            for (int j = 0; j < npairs; ++j) {
+                if (qv_scope_bind_push(thscopes[i]) != QV_SUCCESS ||
+                    qv_scope_bind_pop(thscopes[i]) != QV_SUCCESS) {
+                    nfailed++;
+                    return;
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    const double elapsed = qvi_time() - start;
+    if (nfailed != 0) {
+        ctu_panic("%d threads failed to push or pop", nfailed.load());
+    }
+    printf("# %d threads: %.0f bind push/pop pairs per second\n",
+        nthreads, (nthreads * npairs) / elapsed
+    );
+
+    rc = qv_thread_scopes_free(nthreads, thscopes);
+    if (rc != QV_SUCCESS) {
+        ctu_panic("qv_thread_scopes_free() failed (rc=%s)", qv_strerr(rc));
+    }
+}
+
+int
+main(
+    int argc,
+    char **argv
+) {
+    printf("\n# Starting scope test\n");
+    // Optionally, only run the named benchmark.
+    const std::string bench = (argc > 1 ? argv[1] : "");
+
+    qv_scope_t *base = nullptr;
+    const int rc = qv_process_scope_get(
+        QV_SCOPE_PROCESS, QV_SCOPE_FLAG_NONE, &base
+    );
+    if (rc != QV_SUCCESS) {
+        ctu_panic("qv_process_scope_get() failed (rc=%s)", qv_strerr(rc));
+    }
+    if (bench == "bind-push") {
+        bench_thread_bind_push(base);
+        scope_free(base);
+        printf("# Done\n");
+        return EXIT_SUCCESS;
+    }
+    if (!bench.empty()) ctu_panic("unknown benchmark: %s", bench.c_str());
+
+    check_split_memo(base);
+    check_malloc_placement(base);
+    // Also check a NUMA domain, which is all of it on single-domain hosts.
+    qv_scope_t *numa = nullptr;
+    const int nrc = qv_scope_split_at(base, QV_HW_OBJ_NUMANODE, 0, &numa);
+    if (nrc != QV_SUCCESS) {
+        ctu_panic("qv_scope_split_at() failed (rc=%s)", qv_strerr(nrc));
+    }
+    check_malloc_placement(numa);
+    scope_free(numa);
+    scope_free(base);
+
+    printf("# Done\n");
+    return EXIT_SUCCESS;
+}
+
+/*
+ * vim: ft=cpp ts=4 sts=4 sw=4 expandtab
+ */
@@ -113,6 +113,7 @@ main(
         ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
     }
     printf("[%d] Number of PUs in base_scope is %d\n", wrank, n_pu);
+    const int base_n_pu = n_pu;
 
     const int npieces = 2;
     const int gid = get_group_id(
@@ -146,7 +147,44 @@ main(
     printf("[%d] Number of PUs in sub_scope is %d\n", wrank, n_pu);
 
     ctu_scope_report(sub_scope, "sub_scope");
+
+    /* Repeating an identical split must yield the same resources. */
+    qv_scope_t *again_scope;
+    rc = qv_scope_split(
+        base_scope,
+        npieces,
+        QV_SCOPE_SPLIT_PACKED,
+        &again_scope
+    );
+    if (rc != QV_SUCCESS) {
+        ers = "qv_scope_split() failed";
+        ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
+    }
+    char *sub_binds, *again_binds;
+    rc = qv_scope_bind_string(sub_scope, QV_BIND_STRING_LOGICAL, &sub_binds);
+    if (rc == QV_SUCCESS) {
+        rc = qv_scope_bind_string(
+            again_scope, QV_BIND_STRING_LOGICAL, &again_binds
+        );
+    }
+    if (rc != QV_SUCCESS) {
+        ers = "qv_scope_bind_string() failed";
+        ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
+    }
+    if (strcmp(sub_binds, again_binds) != 0) {
+        ctu_panic("repeated split differs: %s vs %s", sub_binds, again_binds);
+    }
+    free(sub_binds);
+    free(again_binds);
+
+    rc = qv_scope_free(again_scope);
+    if (rc != QV_SUCCESS) {
+        ers = "qv_scope_free() failed";
+        ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
+    }
     ctu_change_bind(sub_scope);
+    ctu_change_membind(sub_scope);
+    ctu_scope_malloc(sub_scope);
 
     if (base_scope_rank == 0) {
         qv_scope_t *create_scope;
@@ -205,6 +243,61 @@ main(
     }
     printf("[%d] Number of PUs in sub_sub_scope is %d\n", wrank, n_pu);
 
+    /* Give the first task three times the resources of the others. */
+    if (base_n_pu >= base_scope_sgsize) {
+        qv_scope_t *weighted_scope;
+        rc = qv_scope_split_weighted(
+            base_scope,
+            base_scope_rank == 0 ? 3 : 1,
+            &weighted_scope
+        );
+        if (rc != QV_SUCCESS) {
+            ers = "qv_scope_split_weighted() failed";
+            ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
+        }
+
+        rc = qv_scope_hw_obj_count(
+            weighted_scope,
+            QV_HW_OBJ_PU,
+            &n_pu
+        );
+        if (rc != QV_SUCCESS) {
+            ers = "qv_scope_hw_obj_count() failed";
+            ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
+        }
+        printf("[%d] Number of PUs in weighted_scope is %d\n", wrank, n_pu);
+        /* With a few PUs per unit of weight, the shares should be close. */
+        const int n_others = (base_scope_rank == 0) ? 0 : n_pu;
+        int sum_others = 0;
+        rc = MPI_Allreduce(
+            &n_others, &sum_others, 1, MPI_INT, MPI_SUM, comm
+        );
+        if (rc != MPI_SUCCESS) {
+            ers = "MPI_Allreduce() failed";
+            ctu_panic("%s (rc=%d)", ers, rc);
+        }
+        const int total_weight = base_scope_sgsize + 2;
+        if (base_scope_rank == 0 && base_scope_sgsize > 1 &&
+            base_n_pu >= 2 * total_weight) {
+            /* Compare against three times the others' average share. */
+            const int scaled = n_pu * (base_scope_sgsize - 1);
+            if (scaled < 2 * sum_others || scaled > 4 * sum_others) {
+                ctu_panic(
+                    "weighted_scope has %d PUs, others average %.2f",
+                    n_pu, (double)sum_others / (base_scope_sgsize - 1)
+                );
+            }
+        }
+
+        ctu_scope_report(weighted_scope, "weighted_scope");
+
+        rc = qv_scope_free(weighted_scope);
+        if (rc != QV_SUCCESS) {
+            ers = "qv_scope_free() failed";
+            ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
+        }
+    }
+
     rc = qv_scope_free(base_scope);
     if (rc != QV_SUCCESS) {
         ers = "qv_scope_free() failed";
@@ -107,6 +107,8 @@ main(void)
     ctu_scope_report(sub_scope, "sub_scope");
 
     ctu_change_bind(sub_scope);
+    ctu_change_membind(sub_scope);
+    ctu_scope_malloc(sub_scope);
 
     rc = qv_scope_free(base_scope);
     if (rc != QV_SUCCESS) {
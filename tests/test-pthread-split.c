@@ -1,26 +1,127 @@
 /* -*- Mode: C; c-basic-offset:4; indent-tabs-mode:nil -*- */
 
+// For the CPU_* macros and sched_getaffinity().
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
 #include "quo-vadis-thread.h"
 #include "common-test-utils.h"
 
+#include <sched.h>
+
 // A convenience structure to hold thread arguments.
 typedef struct {
     qv_scope_t *scope;
+    int rank;
+    int size;
     int answer;
 } thargs_t;
 
+/**
+ * Checks that the calling thread runs on the cpuset it is bound to. Threads
+ * created with default attributes start there without being moved, so this
+ * also checks that they were started in the right place.
+ */
+static void
+check_os_binding(
+    qv_scope_t *scope
+) {
+    char const *ers = NULL;
+
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    if (sched_getaffinity(0, sizeof(cpus), &cpus) != 0) {
+        ctu_panic("sched_getaffinity() failed");
+    }
+    // Format the affinity like a physical bind string, e.g., P0-3,8.
+    char osbinds[4096] = "P";
+    size_t len = 1;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &cpus)) continue;
+        int last = cpu;
+        while (last + 1 < CPU_SETSIZE && CPU_ISSET(last + 1, &cpus)) ++last;
+        const char *const sep = (len == 1) ? "" : ",";
+        if (last == cpu) {
+            len += snprintf(
+                osbinds + len, sizeof(osbinds) - len, "%s%d", sep, cpu
+            );
+        }
+        else {
+            len += snprintf(
+                osbinds + len, sizeof(osbinds) - len, "%s%d-%d", sep, cpu, last
+            );
+        }
+        if (len >= sizeof(osbinds)) ctu_panic("affinity string too long");
+        cpu = last;
+    }
+
+    char *binds = NULL;
+    const int rc = qv_scope_bind_string(scope, QV_BIND_STRING_PHYSICAL, &binds);
+    if (rc != QV_SUCCESS) {
+        ers = "qv_bind_string() failed";
+        ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
+    }
+    if (strcmp(binds, osbinds) != 0) {
+        ctu_panic(
+            "[%d] thread runs on %s, but is bound to %s",
+            ctu_gettid(), osbinds, binds
+        );
+    }
+    free(binds);
+}
+
 void *
 thread_work(
     void *arg
 ) {
     thargs_t *thargs = (thargs_t *)arg;
+    char const *ers = NULL;
 
     if (thargs->answer != 42) {
-        char const *ers = "user arguments not forwarded!";
+        ers = "user arguments not forwarded!";
         ctu_panic("%s", ers);
     }
     printf("Hello from pid=%d,tid=%d\n", getpid(), ctu_gettid());
     ctu_emit_task_bind(thargs->scope);
+    check_os_binding(thargs->scope);
+
+    int rank = 0, size = 0;
+    int rc = qv_scope_group_rank(thargs->scope, &rank);
+    if (rc != QV_SUCCESS) {
+        ers = "qv_scope_group_rank() failed";
+        ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
+    }
+    rc = qv_scope_group_size(thargs->scope, &size);
+    if (rc != QV_SUCCESS) {
+        ers = "qv_scope_group_size() failed";
+        ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
+    }
+    if (rank != thargs->rank || size != thargs->size) {
+        ctu_panic(
+            "unexpected rank=%d size=%d (expected %d, %d)",
+            rank, size, thargs->rank, thargs->size
+        );
+    }
+
+    rc = qv_scope_barrier(thargs->scope);
+    if (rc != QV_SUCCESS) {
+        ers = "qv_scope_barrier() failed";
+        ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
+    }
+    // Threads split their scopes collectively, like processes.
+    qv_scope_t *sub_scope = NULL;
+    rc = qv_scope_split(thargs->scope, 2, rank % 2, &sub_scope);
+    if (rc != QV_SUCCESS) {
+        ers = "qv_scope_split() failed";
+        ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
+    }
+    ctu_emit_task_bind(sub_scope);
+    rc = qv_scope_free(sub_scope);
+    if (rc != QV_SUCCESS) {
+        ers = "qv_scope_free() failed";
+        ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
+    }
     return NULL;
 }
 
@@ -74,6 +175,8 @@ main(void)
     thargs_t thargs[nthreads];
     for (int i = 0 ; i < nthreads; i ++) {
         thargs[i].scope = th_scopes[i];
+        thargs[i].rank = i;
+        thargs[i].size = nthreads;
         thargs[i].answer = 42;
     }
 
@@ -125,18 +228,24 @@ main(void)
     thargs_t thargs2[nthreads];
     for (int i = 0 ; i < nthreads; i++) {
         thargs2[i].scope = th_scopes[i];
+        thargs2[i].rank = i;
+        thargs2[i].size = nthreads;
         thargs2[i].answer = 42;
     }
 
+    // Start the whole team at once this time.
+    void *thargs2p[nthreads];
+    for (int i = 0; i < nthreads; i++) {
+        thargs2p[i] = &thargs2[i];
+    }
+
     pthread_t thid2[nthreads];
-    for (int i  = 0 ; i < nthreads; ++i) {
-        const int ptrc = qv_pthread_create(
-            &thid2[i], attr, thread_work, &thargs2[i], th_scopes[i]
-        );
-        if (ptrc != 0) {
-            ers = "qv_pthread_create() failed";
-            ctu_panic("%s (rc=%s)", ers, strerror(rc));
-        }
+    const int ptrc = qv_pthread_create_team(
+        thid2, attr, thread_work, thargs2p, nthreads, th_scopes
+    );
+    if (ptrc != 0) {
+        ers = "qv_pthread_create_team() failed";
+        ctu_panic("%s (rc=%s)", ers, strerror(ptrc));
     }
 
     for (int i  = 0 ; i < nthreads; ++i) {
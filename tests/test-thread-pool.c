@@ -0,0 +1,232 @@
+/* -*- Mode: C; c-basic-offset:4; indent-tabs-mode:nil -*- */
+
+// For the CPU_* macros and sched_getaffinity().
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "quo-vadis-thread.h"
+#include "common-test-utils.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+#define NTASKS 4096
+#define NCHILDREN 8
+
+/** The affinity a worker reported. */
+typedef struct {
+    pid_t tid;
+    cpu_set_t cpus;
+} worker_affinity_t;
+
+typedef struct {
+    qv_thread_pool_t *pool;
+    atomic_int ntasks_run;
+    /** Protects the fields below. */
+    pthread_mutex_t mutex;
+    /** Affinities of the workers seen so far. */
+    worker_affinity_t *workers;
+    int nworkers_seen;
+    int nworkers;
+} pool_state_t;
+
+static void
+get_affinity(
+    cpu_set_t *cpus
+) {
+    CPU_ZERO(cpus);
+    if (sched_getaffinity(0, sizeof(*cpus), cpus) != 0) {
+        ctu_panic("sched_getaffinity() failed");
+    }
+}
+
+/**
+ * Records the calling worker's affinity, which must not
+ * change from one of the worker's tasks to the next.
+ */
+static void
+record_affinity(
+    pool_state_t *state
+) {
+    const pid_t tid = ctu_gettid();
+    cpu_set_t cpus;
+    get_affinity(&cpus);
+
+    pthread_mutex_lock(&state->mutex);
+    int i = 0;
+    for (; i < state->nworkers_seen; ++i) {
+        if (state->workers[i].tid == tid) break;
+    }
+    if (i == state->nworkers_seen) {
+        if (i == state->nworkers) {
+            ctu_panic("tasks ran on more than %d threads", state->nworkers);
+        }
+        state->workers[i].tid = tid;
+        state->workers[i].cpus = cpus;
+        state->nworkers_seen++;
+    }
+    else if (!CPU_EQUAL(&state->workers[i].cpus, &cpus)) {
+        ctu_panic("worker %d changed its affinity", (int)tid);
+    }
+    pthread_mutex_unlock(&state->mutex);
+}
+
+/**
+ * Checks that the workers ran on disjoint, nonempty pieces of the base cpuset.
+ */
+static void
+check_affinities(
+    const pool_state_t *state,
+    const cpu_set_t *base_cpus
+) {
+    printf("# Tasks ran on %d workers\n", state->nworkers_seen);
+    for (int i = 0; i < state->nworkers_seen; ++i) {
+        const cpu_set_t *cpus = &state->workers[i].cpus;
+        const int tid = (int)state->workers[i].tid;
+        if (tid == (int)ctu_gettid()) {
+            ctu_panic("a task ran on the submitting thread");
+        }
+        if (CPU_COUNT(cpus) == 0) {
+            ctu_panic("worker %d has an empty affinity", tid);
+        }
+        cpu_set_t both;
+        CPU_AND(&both, cpus, base_cpus);
+        if (!CPU_EQUAL(&both, cpus)) {
+            ctu_panic("worker %d runs outside of the base scope", tid);
+        }
+        // Each worker is bound to its own subscope.
+        if (state->nworkers == 1) continue;
+        if (CPU_EQUAL(cpus, base_cpus)) {
+            ctu_panic("worker %d is bound to the whole base scope", tid);
+        }
+        for (int j = i + 1; j < state->nworkers_seen; ++j) {
+            CPU_AND(&both, cpus, &state->workers[j].cpus);
+            if (CPU_COUNT(&both) != 0) {
+                ctu_panic(
+                    "workers %d and %d share cpus",
+                    tid, (int)state->workers[j].tid
+                );
+            }
+        }
+    }
+}
+
+static void
+child_task(
+    void *arg
+) {
+    pool_state_t *state = (pool_state_t *)arg;
+    record_affinity(state);
+    atomic_fetch_add(&state->ntasks_run, 1);
+}
+
+static void
+parent_task(
+    void *arg
+) {
+    pool_state_t *state = (pool_state_t *)arg;
+    record_affinity(state);
+    atomic_fetch_add(&state->ntasks_run, 1);
+    // Tasks may submit more tasks to their pool.
+    for (int i = 0; i < NCHILDREN; ++i) {
+        const int rc = qv_thread_pool_submit(state->pool, child_task, state);
+        if (rc != QV_SUCCESS) {
+            ctu_panic("qv_thread_pool_submit() failed (rc=%s)", qv_strerr(rc));
+        }
+    }
+    // But they may not wait on it.
+    if (qv_thread_pool_wait(state->pool) != QV_ERR_INVLD_ARG) {
+        ctu_panic("qv_thread_pool_wait() succeeded from a task");
+    }
+}
+
+int
+main(void)
+{
+    char const *ers = NULL;
+
+    fprintf(stdout, "# Starting thread pool test.\n");
+
+    cpu_set_t base_cpus;
+    get_affinity(&base_cpus);
+
+    qv_scope_t *base_scope;
+    int rc = qv_process_scope_get(
+        QV_SCOPE_PROCESS, QV_SCOPE_FLAG_NONE, &base_scope
+    );
+    if (rc != QV_SUCCESS) {
+        ers = "qv_process_scope_get() failed";
+        ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
+    }
+
+    int ncores = 0;
+    rc = qv_scope_hw_obj_count(base_scope, QV_HW_OBJ_CORE, &ncores);
+    if (rc != QV_SUCCESS) {
+        ers = "qv_scope_hw_obj_count() failed";
+        ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
+    }
+
+    const int nworkers = ncores;
+    printf("# Creating a pool of %d workers\n", nworkers);
+
+    pool_state_t state;
+    atomic_init(&state.ntasks_run, 0);
+    pthread_mutex_init(&state.mutex, NULL);
+    state.workers = calloc(nworkers, sizeof(*state.workers));
+    if (!state.workers) ctu_panic("calloc() failed");
+    state.nworkers_seen = 0;
+    state.nworkers = nworkers;
+    rc = qv_thread_pool_create(
+        base_scope, nworkers, QV_THREAD_SCOPE_SPLIT_PACKED,
+        nworkers, &state.pool
+    );
+    if (rc != QV_SUCCESS) {
+        ers = "qv_thread_pool_create() failed";
+        ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
+    }
+    // Run a few rounds to make sure the workers survive going idle.
+    const int nrounds = 4;
+    for (int round = 0; round < nrounds; ++round) {
+        for (int i = 0; i < NTASKS; ++i) {
+            rc = qv_thread_pool_submit(state.pool, parent_task, &state);
+            if (rc != QV_SUCCESS) {
+                ers = "qv_thread_pool_submit() failed";
+                ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
+            }
+        }
+        rc = qv_thread_pool_wait(state.pool);
+        if (rc != QV_SUCCESS) {
+            ers = "qv_thread_pool_wait() failed";
+            ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
+        }
+        const int expected = (round + 1) * NTASKS * (1 + NCHILDREN);
+        const int ntasks_run = atomic_load(&state.ntasks_run);
+        if (ntasks_run != expected) {
+            ctu_panic("ran %d tasks, expected %d", ntasks_run, expected);
+        }
+    }
+    check_affinities(&state, &base_cpus);
+
+    rc = qv_thread_pool_free(state.pool);
+    if (rc != QV_SUCCESS) {
+        ers = "qv_thread_pool_free() failed";
+        ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
+    }
+    pthread_mutex_destroy(&state.mutex);
+    free(state.workers);
+
+    rc = qv_scope_free(base_scope);
+    if (rc != QV_SUCCESS) {
+        ers = "qv_scope_free() failed";
+        ctu_panic("%s (rc=%s)", ers, qv_strerr(rc));
+    }
+
+    fprintf(stdout, "# Done.\n");
+    return EXIT_SUCCESS;
+}
+
+/*
+ * vim: ft=cpp ts=4 sts=4 sw=4 expandtab
+ */